@@ -0,0 +1,36 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+
+MULTI_CONF = True
+CONF_BUS_SCHEDULER_ID = "bus_scheduler_id"
+CONF_SENSOR_SLICE = "sensor_slice"
+
+bus_scheduler_ns = cg.esphome_ns.namespace("bus_scheduler")
+BusScheduler = bus_scheduler_ns.class_("BusScheduler", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(BusScheduler),
+        cv.Optional(CONF_SENSOR_SLICE, default=1): cv.int_range(min=1, max=16),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+BUS_SCHEDULER_CLIENT_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_BUS_SCHEDULER_ID): cv.use_id(BusScheduler),
+    }
+)
+
+
+async def register_bus_client(var, config):
+    if CONF_BUS_SCHEDULER_ID in config:
+        sched = await cg.get_variable(config[CONF_BUS_SCHEDULER_ID])
+        cg.add(var.set_bus_scheduler(sched))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    cg.add(var.set_sensor_slice(config[CONF_SENSOR_SLICE]))
+    cg.add_define("USE_BUS_SCHEDULER")
@@ -0,0 +1,67 @@
+#include "bus_scheduler.h"
+
+#include <algorithm>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace bus_scheduler {
+
+static const char *const TAG = "bus_scheduler";
+
+void BusScheduler::dump_config() {
+  ESP_LOGCONFIG(TAG, "Bus scheduler:");
+  ESP_LOGCONFIG(TAG, "  Sensor steps per loop: %u", this->sensor_slice_);
+  ESP_LOGCONFIG(TAG, "  Max actuator wait: %u ms", this->max_actuator_wait_);
+}
+
+void BusScheduler::submit(BusPriority priority, BusJobStep &&step) {
+  const uint32_t now = millis();
+  this->jobs_.push_back(Job{priority, std::move(step), now, now, false});
+}
+
+void BusScheduler::run_step_(size_t i, uint32_t now) {
+  // take the job out first, its step may submit new jobs
+  Job job = std::move(this->jobs_[i]);
+  this->jobs_.erase(this->jobs_.begin() + i);
+  if (job.priority == BUS_PRIORITY_ACTUATOR && !job.started) {
+    this->max_actuator_wait_ = std::max(this->max_actuator_wait_, now - job.submitted_at);
+  }
+  job.started = true;
+  uint32_t wait = job.step();
+  if (wait == BUS_JOB_DONE)
+    return;
+  // back of the queue, so jobs of the same priority take turns
+  job.ready_at = millis() + wait;
+  this->jobs_.push_back(std::move(job));
+}
+
+void BusScheduler::loop() {
+  const uint32_t now = millis();
+  // actuators first, every ready one
+  size_t pending = this->jobs_.size();
+  for (size_t i = 0; i < this->jobs_.size() && pending > 0; pending--) {
+    const Job &job = this->jobs_[i];
+    if (job.priority == BUS_PRIORITY_ACTUATOR && static_cast<int32_t>(now - job.ready_at) >= 0) {
+      this->run_step_(i, now);
+    } else {
+      i++;
+    }
+  }
+
+  // then a bounded number of sensor steps
+  uint8_t steps = 0;
+  pending = this->jobs_.size();
+  for (size_t i = 0; i < this->jobs_.size() && pending > 0 && steps < this->sensor_slice_; pending--) {
+    const Job &job = this->jobs_[i];
+    if (job.priority == BUS_PRIORITY_SENSOR && static_cast<int32_t>(now - job.ready_at) >= 0) {
+      this->run_step_(i, now);
+      steps++;
+    } else {
+      i++;
+    }
+  }
+}
+
+}  // namespace bus_scheduler
+}  // namespace esphome
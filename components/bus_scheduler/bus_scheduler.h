@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace bus_scheduler {
+
+enum BusPriority : uint8_t { BUS_PRIORITY_ACTUATOR = 0, BUS_PRIORITY_SENSOR = 1 };
+
+/// Returned by a job step when the job is finished.
+static const uint32_t BUS_JOB_DONE = UINT32_MAX;
+
+/// A job step runs a few bus transactions and returns the time in ms to wait before its next step,
+/// or BUS_JOB_DONE.
+using BusJobStep = std::function<uint32_t()>;
+
+/// Cooperative scheduler for devices sharing one I2C bus.
+///
+/// Actuator jobs run first on every loop, sensor jobs are interleaved step by step so a
+/// multi-transaction sensor read never holds the bus (and the main loop) for longer than one step.
+class BusScheduler : public Component {
+ public:
+  void set_sensor_slice(uint8_t sensor_slice) { sensor_slice_ = sensor_slice; }
+
+  void submit(BusPriority priority, BusJobStep &&step);
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  void dump_config() override;
+  void loop() override;
+
+ protected:
+  struct Job {
+    BusPriority priority;
+    BusJobStep step;
+    uint32_t submitted_at;
+    uint32_t ready_at;
+    bool started;
+  };
+
+  // Run one step of job i, the job is requeued at the back unless it's done
+  void run_step_(size_t i, uint32_t now);
+
+  std::vector<Job> jobs_;
+  uint8_t sensor_slice_ = 1;
+  uint32_t max_actuator_wait_ = 0;
+};
+
+}  // namespace bus_scheduler
+}  // namespace esphome
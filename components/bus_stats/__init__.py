@@ -0,0 +1,75 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_EMPTY,
+)
+
+AUTO_LOAD = ["sensor"]
+
+CONF_BUS_STATS = "bus_stats"
+CONF_TRANSACTIONS = "transactions"
+CONF_ERRORS = "errors"
+CONF_BYTES = "bytes"
+CONF_LATENCY = "latency"
+CONF_MAX_LATENCY = "max_latency"
+UNIT_MICROSECOND = "µs"
+ICON_COUNTER = "mdi:counter"
+ICON_TIMER = "mdi:timer-outline"
+
+bus_stats_ns = cg.esphome_ns.namespace("bus_stats")
+BusStats = bus_stats_ns.class_("BusStats", cg.PollingComponent)
+
+
+def counter_schema():
+    return sensor.sensor_schema(
+        unit_of_measurement=UNIT_EMPTY,
+        icon=ICON_COUNTER,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+def latency_schema():
+    return sensor.sensor_schema(
+        unit_of_measurement=UNIT_MICROSECOND,
+        icon=ICON_TIMER,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+BUS_STATS_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(BusStats),
+        cv.Optional(CONF_TRANSACTIONS): counter_schema(),
+        cv.Optional(CONF_ERRORS): counter_schema(),
+        cv.Optional(CONF_BYTES): counter_schema(),
+        cv.Optional(CONF_LATENCY): latency_schema(),
+        cv.Optional(CONF_MAX_LATENCY): latency_schema(),
+    }
+).extend(cv.polling_component_schema("60s"))
+
+SENSORS = {
+    CONF_TRANSACTIONS: "set_transactions_sensor",
+    CONF_ERRORS: "set_errors_sensor",
+    CONF_BYTES: "set_bytes_sensor",
+    CONF_LATENCY: "set_latency_sensor",
+    CONF_MAX_LATENCY: "set_max_latency_sensor",
+}
+
+
+async def new_bus_stats(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    for key, setter in SENSORS.items():
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, setter)(sens))
+    return var
@@ -0,0 +1,61 @@
+#include "bus_stats.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace bus_stats {
+
+void BusStats::record(uint32_t start_us, uint8_t bytes, bool ok, uint8_t transactions) {
+  this->latency_[this->latency_index_] = micros() - start_us;
+  this->latency_index_ = (this->latency_index_ + 1) % BUS_STATS_LATENCY_SAMPLES;
+  if (this->latency_count_ < BUS_STATS_LATENCY_SAMPLES)
+    this->latency_count_++;
+  this->transactions_ += transactions;
+  this->bytes_ += bytes;
+  if (!ok)
+    this->errors_++;
+}
+
+void BusStats::get_latency(uint32_t *min_us, uint32_t *avg_us, uint32_t *max_us) const {
+  uint32_t lo = UINT32_MAX;
+  uint32_t hi = 0;
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < this->latency_count_; i++) {
+    uint32_t l = this->latency_[i];
+    lo = std::min(lo, l);
+    hi = std::max(hi, l);
+    sum += l;
+  }
+  *min_us = this->latency_count_ > 0 ? lo : 0;
+  *avg_us = this->latency_count_ > 0 ? sum / this->latency_count_ : 0;
+  *max_us = hi;
+}
+
+void BusStats::log_stats(const char *tag) const {
+  uint32_t min_us, avg_us, max_us;
+  this->get_latency(&min_us, &avg_us, &max_us);
+  ESP_LOGCONFIG(tag, "  Bus transactions: %u (%u NACK/errors), %u bytes", this->transactions_, this->errors_,
+                this->bytes_);
+  ESP_LOGCONFIG(tag, "  Bus latency: min %u us, avg %u us, max %u us", min_us, avg_us, max_us);
+}
+
+void BusStats::update() {
+  uint32_t min_us, avg_us, max_us;
+  this->get_latency(&min_us, &avg_us, &max_us);
+  if (this->transactions_sensor_ != nullptr)
+    this->transactions_sensor_->publish_state(this->transactions_);
+  if (this->errors_sensor_ != nullptr)
+    this->errors_sensor_->publish_state(this->errors_);
+  if (this->bytes_sensor_ != nullptr)
+    this->bytes_sensor_->publish_state(this->bytes_);
+  if (this->latency_sensor_ != nullptr)
+    this->latency_sensor_->publish_state(avg_us);
+  if (this->max_latency_sensor_ != nullptr)
+    this->max_latency_sensor_->publish_state(max_us);
+}
+
+}  // namespace bus_stats
+}  // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome {
+namespace bus_stats {
+
+static const uint8_t BUS_STATS_LATENCY_SAMPLES = 16;
+
+/// Transaction, NACK, byte and latency counters for the I2C helpers of a device.
+class BusStats : public PollingComponent {
+ public:
+  void set_transactions_sensor(sensor::Sensor *transactions_sensor) { transactions_sensor_ = transactions_sensor; }
+  void set_errors_sensor(sensor::Sensor *errors_sensor) { errors_sensor_ = errors_sensor; }
+  void set_bytes_sensor(sensor::Sensor *bytes_sensor) { bytes_sensor_ = bytes_sensor; }
+  void set_latency_sensor(sensor::Sensor *latency_sensor) { latency_sensor_ = latency_sensor; }
+  void set_max_latency_sensor(sensor::Sensor *max_latency_sensor) { max_latency_sensor_ = max_latency_sensor; }
+
+  /// Record one access started at start_us (micros()) that moved bytes on the wire in the given
+  /// number of transactions: a register read is 2, the register write and the read.
+  void record(uint32_t start_us, uint8_t bytes, bool ok, uint8_t transactions = 1);
+  /// Latency of the last BUS_STATS_LATENCY_SAMPLES accesses, in microseconds.
+  void get_latency(uint32_t *min_us, uint32_t *avg_us, uint32_t *max_us) const;
+  /// Log the counters, called from the owner's dump_config().
+  void log_stats(const char *tag) const;
+
+  uint32_t get_transactions() const { return transactions_; }
+  uint32_t get_errors() const { return errors_; }
+  uint32_t get_bytes() const { return bytes_; }
+
+  // ========== INTERNAL METHODS ==========
+  // (In most use cases you won't need these)
+  void update() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+ protected:
+  sensor::Sensor *transactions_sensor_{nullptr};
+  sensor::Sensor *errors_sensor_{nullptr};
+  sensor::Sensor *bytes_sensor_{nullptr};
+  sensor::Sensor *latency_sensor_{nullptr};
+  sensor::Sensor *max_latency_sensor_{nullptr};
+
+  uint32_t transactions_ = 0;
+  uint32_t errors_ = 0;
+  uint32_t bytes_ = 0;
+  uint32_t latency_[BUS_STATS_LATENCY_SAMPLES];
+  uint8_t latency_index_ = 0;
+  uint8_t latency_count_ = 0;
+};
+
+}  // namespace bus_stats
+}  // namespace esphome
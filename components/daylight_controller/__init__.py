@@ -0,0 +1,61 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.components.mcp4728.output import MCP4728Channel
+from esphome.const import CONF_ID, CONF_SENSOR
+
+DEPENDENCIES = ["mcp4728"]
+MULTI_CONF = True
+CONF_OUTPUTS = "outputs"
+CONF_TARGET = "target"
+CONF_KP = "kp"
+CONF_KI = "ki"
+CONF_FEED_FORWARD = "feed_forward"
+CONF_MIN_LEVEL = "min_level"
+CONF_MAX_LEVEL = "max_level"
+CONF_MAX_SLEW = "max_slew"
+
+daylight_controller_ns = cg.esphome_ns.namespace("daylight_controller")
+DaylightController = daylight_controller_ns.class_(
+    "DaylightController", cg.Component
+)
+
+
+def validate_level_range(config):
+    if config[CONF_MIN_LEVEL] >= config[CONF_MAX_LEVEL]:
+        raise cv.Invalid(f"{CONF_MIN_LEVEL} must be lower than {CONF_MAX_LEVEL}")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(DaylightController),
+            cv.Required(CONF_SENSOR): cv.use_id(sensor.Sensor),
+            cv.Required(CONF_OUTPUTS): cv.ensure_list(cv.use_id(MCP4728Channel)),
+            cv.Required(CONF_TARGET): cv.positive_float,
+            cv.Optional(CONF_KP, default=0.0): cv.float_,
+            cv.Optional(CONF_KI, default=0.0): cv.float_,
+            cv.Optional(CONF_FEED_FORWARD, default=0.0): cv.float_,
+            cv.Optional(CONF_MIN_LEVEL, default=0.0): cv.percentage,
+            cv.Optional(CONF_MAX_LEVEL, default=1.0): cv.percentage,
+            cv.Optional(CONF_MAX_SLEW, default=0.0): cv.positive_float,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_level_range,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    sens = await cg.get_variable(config[CONF_SENSOR])
+    cg.add(var.set_sensor(sens))
+    for output_id in config[CONF_OUTPUTS]:
+        out = await cg.get_variable(output_id)
+        cg.add(var.add_output(out))
+    cg.add(var.set_target(config[CONF_TARGET]))
+    cg.add(var.set_gains(config[CONF_KP], config[CONF_KI]))
+    cg.add(var.set_feed_forward(config[CONF_FEED_FORWARD]))
+    cg.add(var.set_level_range(config[CONF_MIN_LEVEL], config[CONF_MAX_LEVEL]))
+    cg.add(var.set_max_slew(config[CONF_MAX_SLEW]))
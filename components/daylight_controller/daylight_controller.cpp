@@ -0,0 +1,72 @@
+#include "daylight_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace daylight_controller {
+
+static const char *const TAG = "daylight_controller";
+
+// longest sample period used for the integral and slew terms, in seconds
+static const float MAX_DT = 10.0f;
+
+void DaylightController::setup() {
+  this->sensor_->add_on_state_callback([this](float lux) { this->control_(lux); });
+}
+
+void DaylightController::dump_config() {
+  ESP_LOGCONFIG(TAG, "Daylight controller:");
+  ESP_LOGCONFIG(TAG, "  Target: %.1f lx", this->target_);
+  ESP_LOGCONFIG(TAG, "  Kp: %g, Ki: %g, Feed forward: %g", this->kp_, this->ki_, this->feed_forward_);
+  ESP_LOGCONFIG(TAG, "  Level range: %.3f - %.3f", this->min_level_, this->max_level_);
+  if (this->max_slew_ > 0.0f) {
+    ESP_LOGCONFIG(TAG, "  Max slew: %.3f/s", this->max_slew_);
+  }
+  ESP_LOGCONFIG(TAG, "  Outputs: %zu", this->outputs_.size());
+}
+
+void DaylightController::control_(float lux) {
+  if (std::isnan(lux))
+    return;
+
+  const uint32_t now = millis();
+  float dt = this->started_ ? (now - this->last_sample_) / 1000.0f : 0.0f;
+  dt = std::min(dt, MAX_DT);
+  this->last_sample_ = now;
+
+  const float error = this->target_ - lux;
+  const float base = this->feed_forward_ * this->target_ + this->kp_ * error;
+  float integral = this->integral_ + this->ki_ * error * dt;
+  const float unlimited = base + integral;
+  float level = std::max(this->min_level_, std::min(this->max_level_, unlimited));
+  if (this->started_ && this->max_slew_ > 0.0f) {
+    const float step = this->max_slew_ * dt;
+    level = std::max(this->level_ - step, std::min(this->level_ + step, level));
+  }
+
+  // anti-windup: stop integrating while the output is held back by the level range or the slew
+  // limit in the direction of the error
+  if ((level < unlimited && error > 0.0f) || (level > unlimited && error < 0.0f))
+    integral = this->integral_;
+  this->integral_ = integral;
+
+  ESP_LOGV(TAG, "lux=%.1f error=%.1f integral=%.4f level=%.4f", lux, error, this->integral_, level);
+  // the first level is always written: the outputs may hold anything from before the boot, while
+  // level_ starts at 0
+  if (!this->started_ || level != this->level_)
+    this->write_level_(level);
+  this->started_ = true;
+}
+
+void DaylightController::write_level_(float level) {
+  this->level_ = level;
+  for (auto *output : this->outputs_)
+    output->set_level(level);
+}
+
+}  // namespace daylight_controller
+}  // namespace esphome
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/components/mcp4728/mcp4728_output.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace daylight_controller {
+
+/// Holds a target illuminance by driving MCP4728 channels from a lux sensor.
+///
+/// The control step runs in the sensor's state callback, so the outputs follow each new sample
+/// on the same loop. The output level is feed_forward * target + PI term, with anti-windup and
+/// an optional slew rate limit.
+class DaylightController : public Component {
+ public:
+  void set_sensor(sensor::Sensor *sensor) { sensor_ = sensor; }
+  void add_output(mcp4728::MCP4728Channel *output) { outputs_.push_back(output); }
+  void set_target(float target) { target_ = target; }
+  void set_gains(float kp, float ki) {
+    kp_ = kp;
+    ki_ = ki;
+  }
+  void set_feed_forward(float feed_forward) { feed_forward_ = feed_forward; }
+  void set_level_range(float min_level, float max_level) {
+    min_level_ = min_level;
+    max_level_ = max_level;
+  }
+  void set_max_slew(float max_slew) { max_slew_ = max_slew; }
+
+  float get_target() const { return target_; }
+  float get_level() const { return level_; }
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+ protected:
+  void control_(float lux);
+  void write_level_(float level);
+
+  sensor::Sensor *sensor_{nullptr};
+  std::vector<mcp4728::MCP4728Channel *> outputs_;
+  float target_ = 0.0f;
+  float kp_ = 0.0f;
+  float ki_ = 0.0f;
+  float feed_forward_ = 0.0f;
+  float min_level_ = 0.0f;
+  float max_level_ = 1.0f;
+  // max level change per second, 0 disables the limit
+  float max_slew_ = 0.0f;
+
+  float integral_ = 0.0f;
+  float level_ = 0.0f;
+  uint32_t last_sample_ = 0;
+  bool started_ = false;
+};
+
+}  // namespace daylight_controller
+}  // namespace esphome
@@ -1,7 +1,15 @@
 #include "max44009.h"
 
+#include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cmath>
+
+#ifdef USE_ESP32
+#include <esp_attr.h>
+#endif
+
 namespace esphome {
 namespace max44009 {
 
@@ -19,21 +27,32 @@ static const uint8_t MAX44009_ERROR_WIRE_REQUEST = -10;
 static const uint8_t MAX44009_ERROR_OVERFLOW = -20;
 static const uint8_t MAX44009_ERROR_HIGH_BYTE = -30;
 static const uint8_t MAX44009_ERROR_LOW_BYTE = -31;
+// RTC state
+static const uint32_t MAX44009_RTC_MAGIC = 0x4D443039;
+// One measure every 800ms in low power mode, the first reading after a cold boot is ready by then
+static const uint32_t MAX44009_LOW_POWER_CYCLE = 800;
+static const uint32_t MAX44009_FIRST_READING_DELAY = MAX44009_LOW_POWER_CYCLE;
 
-inline int convert_to_lux(uint8_t datahigh, uint8_t datalow) {
-  uint8_t exponent = datahigh >> 4;
-  uint32_t mantissa = ((datahigh & 0x0F) << 4) + (datalow & 0x0F);
-  float lux = ((0x0001 << exponent) * 0.045) * mantissa;
-  return roundf(lux);
-}
+#ifdef USE_ESP32
+// RTC slow memory survives deep sleep, one slot per address (0x4A/0x4B)
+static RTC_DATA_ATTR MAX44009RtcState rtc_states[2];  // NOLINT
+#endif
 
 void MAX44009Sensor::setup() {
   ESP_LOGCONFIG(TAG, "Setting up MAX44009...");
+  this->trace_.init(this->trace_size_);
+  // after deep sleep, the sensor still has the mode applied before going to sleep
+  const bool warm = this->load_rtc_();
   bool state_ok = false;
   if (this->mode_ == MAX44009Mode::MAX44009_MODE_LOW_POWER) {
-    state_ok = this->set_low_power_mode();
+    state_ok = this->apply_mode_(false);
   } else if (this->mode_ == MAX44009Mode::MAX44009_MODE_CONTINUOUS) {
-    state_ok = this->set_continuous_mode();
+    state_ok = this->apply_mode_(true);
+  } else if (this->mode_ == MAX44009Mode::MAX44009_MODE_ADAPTIVE) {
+    // start slow, adapt_() speeds up when lux starts changing
+    if (!warm)
+      this->set_update_interval(this->adaptive_max_interval_);
+    state_ok = this->apply_mode_for_interval_(this->get_update_interval());
   } else {
     /*
      * Mode AUTO: Set mode depending on update interval
@@ -41,19 +60,66 @@ void MAX44009Sensor::setup() {
      * regardless of integration time
      * - On continuous mode, the IC continuously measures lux intensity
      */
-    if (this->get_update_interval() < 800) {
-      state_ok = this->set_continuous_mode();
-    } else {
-      state_ok = this->set_low_power_mode();
-    }
+    state_ok = this->apply_mode_for_interval_(this->get_update_interval());
   }
-  if (!state_ok)
+  if (!state_ok) {
     this->mark_failed();
+    return;
+  }
+  // publish a first value without waiting a full update interval
+  if (warm) {
+    this->defer([this]() { this->update(); });
+  } else {
+    this->set_timeout("first_reading", MAX44009_FIRST_READING_DELAY, [this]() { this->update(); });
+  }
+}
+
+uint32_t MAX44009Sensor::rtc_magic_() const { return MAX44009_RTC_MAGIC ^ (this->mode_ << 8) ^ this->address_; }
+
+bool MAX44009Sensor::load_rtc_() {
+  MAX44009RtcState state{};
+#ifdef USE_ESP32
+  state = rtc_states[this->address_ & 1];
+#else
+  this->rtc_ = global_preferences->make_preference<MAX44009RtcState>(fnv1_hash("max44009") ^ this->address_, false);
+  if (!this->rtc_.load(&state))
+    return false;
+#endif
+  if (state.magic != this->rtc_magic_())
+    return false;
+  this->continuous_ = state.continuous;
+  this->mode_applied_ = true;
+  if (this->mode_ == MAX44009Mode::MAX44009_MODE_ADAPTIVE)
+    this->set_update_interval(
+        std::min(std::max(state.update_interval, this->adaptive_min_interval_), this->adaptive_max_interval_));
+  ESP_LOGD(TAG, "Restored %s mode from RTC memory", this->continuous_ ? "continuous" : "low power");
+  return true;
+}
+
+void MAX44009Sensor::save_rtc_() {
+  MAX44009RtcState state{this->rtc_magic_(), this->get_update_interval(), this->continuous_};
+#ifdef USE_ESP32
+  rtc_states[this->address_ & 1] = state;
+#else
+  this->rtc_.save(&state);
+#endif
 }
 
 void MAX44009Sensor::dump_config() {
   ESP_LOGCONFIG(TAG, "MAX44009:");
   LOG_I2C_DEVICE(this);
+  if (this->mode_ == MAX44009Mode::MAX44009_MODE_ADAPTIVE) {
+    ESP_LOGCONFIG(TAG, "  Adaptive interval: %u-%u ms, threshold %.0f%%/min, deadband %.1f lx",
+                  this->adaptive_min_interval_, this->adaptive_max_interval_, this->adaptive_threshold_ * 100.0f,
+                  this->adaptive_deadband_);
+  }
+  if (this->bus_stats_ != nullptr) {
+    this->bus_stats_->log_stats(TAG);
+  }
+  if (this->trace_.is_enabled()) {
+    ESP_LOGCONFIG(TAG, "  Trace: %zu/%zu samples", this->trace_.size(), this->trace_size_);
+    this->dump_trace();
+  }
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with MAX44009 failed!");
   }
@@ -62,6 +128,23 @@ void MAX44009Sensor::dump_config() {
 float MAX44009Sensor::get_setup_priority() const { return setup_priority::DATA; }
 
 void MAX44009Sensor::update() {
+#ifdef USE_BUS_SCHEDULER
+  if (this->bus_scheduler_ != nullptr) {
+    if (this->measure_pending_)
+      return;
+    this->measure_pending_ = true;
+    this->bus_scheduler_->submit(bus_scheduler::BUS_PRIORITY_SENSOR, [this]() -> uint32_t {
+      this->measure_pending_ = false;
+      this->measure_();
+      return bus_scheduler::BUS_JOB_DONE;
+    });
+    return;
+  }
+#endif
+  this->measure_();
+}
+
+void MAX44009Sensor::measure_() {
   // update sensor illuminance value
   float lux = this->read_illuminance_();
   if (this->error_ != MAX44009_OK) {
@@ -69,7 +152,54 @@ void MAX44009Sensor::update() {
   } else {
     this->status_clear_error();
     this->publish_state(lux);
+    if (this->mode_ == MAX44009Mode::MAX44009_MODE_ADAPTIVE)
+      this->adapt_(lux);
+  }
+}
+
+void MAX44009Sensor::adapt_(float lux) {
+  const uint32_t now = millis();
+  if (std::isnan(this->last_lux_)) {
+    this->last_lux_ = lux;
+    this->last_lux_time_ = now;
+    return;
   }
+  // one mantissa count at the current exponent, plus rounding both readings to whole lux, is
+  // quantisation: at 20000 lx a count is 92 lx, 55%/min at a 500ms interval
+  const float deadband = std::max(this->adaptive_deadband_, lux_step(this->exponent_) + 1.0f);
+  const float rate = lux_change_rate(this->last_lux_, lux, now - this->last_lux_time_, deadband);
+  // within the deadband the reference is kept, so a slow drift adds up until it counts
+  if (rate > 0.0f) {
+    this->last_lux_ = lux;
+    this->last_lux_time_ = now;
+  }
+
+  uint32_t interval = this->get_update_interval();
+  if (rate > this->adaptive_threshold_) {
+    interval = this->adaptive_min_interval_;
+    this->stable_count_ = 0;
+  } else if (++this->stable_count_ >= this->adaptive_stable_samples_) {
+    // back off gradually
+    interval = std::min(interval * 2, this->adaptive_max_interval_);
+    this->stable_count_ = 0;
+  }
+  if (interval == this->get_update_interval())
+    return;
+
+  ESP_LOGD(TAG, "Changing update interval to %u ms (%.0f%%/min)", interval, rate * 100.0f);
+  this->set_update_interval(interval);
+  this->apply_mode_for_interval_(interval);
+  this->save_rtc_();
+  this->stop_poller();
+  this->start_poller();
+}
+
+bool MAX44009Sensor::apply_mode_for_interval_(uint32_t interval) { return this->apply_mode_(interval < MAX44009_LOW_POWER_CYCLE); }
+
+bool MAX44009Sensor::apply_mode_(bool continuous) {
+  if (this->mode_applied_ && continuous == this->continuous_)
+    return true;
+  return continuous ? this->set_continuous_mode() : this->set_low_power_mode();
 }
 
 float MAX44009Sensor::read_illuminance_() {
@@ -83,21 +213,31 @@ float MAX44009Sensor::read_illuminance_() {
     this->error_ = MAX44009_ERROR_LOW_BYTE;
     return this->error_;
   }
+  if (this->trace_.is_enabled()) {
+    this->trace_.push(MAX44009TraceSample{millis(), datahigh, datalow});
+  }
   uint8_t exponent = datahigh >> 4;
   if (exponent == 0x0F) {
     this->error_ = MAX44009_ERROR_OVERFLOW;
     return this->error_;
   }
 
+  this->exponent_ = exponent;
+
   float lux = convert_to_lux(datahigh, datalow);
   return lux;
 }
 
+void MAX44009Sensor::dump_trace() { this->trace_.dump("max44009", ""); }
+
 bool MAX44009Sensor::set_continuous_mode() {
   uint8_t config = read(MAX44009_REGISTER_CONFIGURATION);
   if (this->error_ == MAX44009_OK) {
     config |= MAX44009_CFG_CONTINUOUS;
     this->write(MAX44009_REGISTER_CONFIGURATION, config);
+    this->continuous_ = true;
+    this->mode_applied_ = true;
+    this->save_rtc_();
     this->status_clear_error();
     return true;
   } else {
@@ -111,6 +251,9 @@ bool MAX44009Sensor::set_low_power_mode() {
   if (this->error_ == MAX44009_OK) {
     config &= ~MAX44009_CFG_CONTINUOUS;
     this->write(MAX44009_REGISTER_CONFIGURATION, config);
+    this->continuous_ = false;
+    this->mode_applied_ = true;
+    this->save_rtc_();
     this->status_clear_error();
     return true;
   } else {
@@ -121,7 +264,11 @@ bool MAX44009Sensor::set_low_power_mode() {
 
 uint8_t MAX44009Sensor::read(uint8_t reg) {
   uint8_t data = 0;
-  if (!this->read_byte(reg, &data)) {
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->read_byte(reg, &data);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 4, ok, 2);
+  if (!ok) {
     this->error_ = MAX44009_ERROR_WIRE_REQUEST;
   } else {
     this->error_ = MAX44009_OK;
@@ -130,7 +277,11 @@ uint8_t MAX44009Sensor::read(uint8_t reg) {
 }
 
 void MAX44009Sensor::write(uint8_t reg, uint8_t value) {
-  if (!this->write_byte(reg, value)) {
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->write_byte(reg, value);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 3, ok);
+  if (!ok) {
     this->error_ = MAX44009_ERROR_WIRE_REQUEST;
   } else {
     this->error_ = MAX44009_OK;
@@ -139,5 +290,14 @@ void MAX44009Sensor::write(uint8_t reg, uint8_t value) {
 
 void MAX44009Sensor::set_mode(MAX44009Mode mode) { this->mode_ = mode; }
 
+void MAX44009Sensor::set_adaptive(uint32_t min_interval, uint32_t max_interval, float threshold, float deadband,
+                                  uint8_t stable_samples) {
+  this->adaptive_min_interval_ = min_interval;
+  this->adaptive_max_interval_ = max_interval;
+  this->adaptive_threshold_ = threshold;
+  this->adaptive_deadband_ = deadband;
+  this->adaptive_stable_samples_ = stable_samples;
+}
+
 }  // namespace max44009
 }  // namespace esphome
@@ -1,13 +1,34 @@
 #pragma once
 
+#include "esphome/components/bus_stats/bus_stats.h"
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/components/sample_trace/sample_trace.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
+#include "max44009_calc.h"
+
+#ifdef USE_BUS_SCHEDULER
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#endif
 
 namespace esphome {
 namespace max44009 {
 
-enum MAX44009Mode { MAX44009_MODE_AUTO, MAX44009_MODE_LOW_POWER, MAX44009_MODE_CONTINUOUS };
+enum MAX44009Mode {
+  MAX44009_MODE_AUTO,
+  MAX44009_MODE_LOW_POWER,
+  MAX44009_MODE_CONTINUOUS,
+  MAX44009_MODE_ADAPTIVE
+};
+
+/// Applied configuration, kept in RTC memory so a deep sleep wake-up can skip the configuration.
+struct MAX44009RtcState {
+  uint32_t magic;
+  uint32_t update_interval;
+  uint8_t continuous;
+};
 
 /// This class implements support for the MAX44009 Illuminance i2c sensor.
 class MAX44009Sensor : public sensor::Sensor, public PollingComponent, public i2c::I2CDevice {
@@ -21,17 +42,64 @@ class MAX44009Sensor : public sensor::Sensor, public PollingComponent, public i2
   float get_setup_priority() const override;
   void update() override;
   void set_mode(MAX44009Mode mode);
+  void set_adaptive(uint32_t min_interval, uint32_t max_interval, float threshold, float deadband,
+                    uint8_t stable_samples);
+  void set_bus_stats(bus_stats::BusStats *bus_stats) { bus_stats_ = bus_stats; }
+  void set_trace_size(size_t trace_size) { trace_size_ = trace_size; }
+  /// Log the captured raw samples for tools/trace_replay.cpp
+  void dump_trace();
+#ifdef USE_BUS_SCHEDULER
+  void set_bus_scheduler(bus_scheduler::BusScheduler *bus_scheduler) { bus_scheduler_ = bus_scheduler; }
+#endif
   bool set_continuous_mode();
   bool set_low_power_mode();
 
  protected:
+  /// Read and publish the illuminance value
+  void measure_();
   /// Read the illuminance value
   float read_illuminance_();
+  /// Pick the poll interval and measure mode from the rate of change of lux
+  void adapt_(float lux);
+  /// Continuous mode for intervals shorter than a low power measure cycle (800ms)
+  bool apply_mode_for_interval_(uint32_t interval);
+  /// Write the measure mode unless it's already applied
+  bool apply_mode_(bool continuous);
+  /// Restore the applied mode saved before deep sleep, returns false after a cold boot
+  bool load_rtc_();
+  void save_rtc_();
+  uint32_t rtc_magic_() const;
   uint8_t read(uint8_t reg);
   void write(uint8_t reg, uint8_t value);
 
   int error_;
   MAX44009Mode mode_;
+  bool continuous_ = false;
+  bool mode_applied_ = false;
+  // exponent of the last reading
+  uint8_t exponent_ = 0;
+#ifndef USE_ESP32
+  ESPPreferenceObject rtc_;
+#endif
+
+  // Adaptive mode
+  uint32_t adaptive_min_interval_ = 500;
+  uint32_t adaptive_max_interval_ = 60000;
+  // Relative change per minute that counts as changing quickly
+  float adaptive_threshold_ = 0.2f;
+  // Absolute change (lx) below which lux counts as stable, raised to one count at the current exponent
+  float adaptive_deadband_ = 2.0f;
+  uint8_t adaptive_stable_samples_ = 3;
+  uint8_t stable_count_ = 0;
+  float last_lux_ = NAN;
+  uint32_t last_lux_time_ = 0;
+  bus_stats::BusStats *bus_stats_{nullptr};
+  size_t trace_size_ = 0;
+  sample_trace::SampleTrace<MAX44009TraceSample> trace_;
+#ifdef USE_BUS_SCHEDULER
+  bus_scheduler::BusScheduler *bus_scheduler_{nullptr};
+  bool measure_pending_ = false;
+#endif
 };
 
 }  // namespace max44009
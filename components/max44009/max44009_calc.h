@@ -0,0 +1,40 @@
+#pragma once
+
+// Lux conversion and adaptive rate of the MAX44009, free of ESPHome dependencies so it can be
+// reused by the host trace replay tool (tools/trace_replay.cpp).
+
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace max44009 {
+
+/// Raw sample captured by the trace mode, little endian as stored on the device.
+struct MAX44009TraceSample {
+  uint32_t timestamp;
+  uint8_t datahigh;
+  uint8_t datalow;
+} __attribute__((packed));
+
+inline int convert_to_lux(uint8_t datahigh, uint8_t datalow) {
+  uint8_t exponent = datahigh >> 4;
+  uint32_t mantissa = ((datahigh & 0x0F) << 4) + (datalow & 0x0F);
+  float lux = ((0x0001 << exponent) * 0.045) * mantissa;
+  return roundf(lux);
+}
+
+/// Lux of one mantissa count at the given exponent.
+inline float lux_step(uint8_t exponent) { return (0x0001 << exponent) * 0.045f; }
+
+/// Relative change of lux per minute since the reference reading taken dt_ms earlier. A change
+/// within the absolute deadband (lx) returns 0, so the 0/1 lx noise of a dark room doesn't read
+/// as a 100%/min change.
+inline float lux_change_rate(float reference, float lux, uint32_t dt_ms, float deadband) {
+  const float change = std::fabs(lux - reference);
+  if (change <= deadband)
+    return 0.0f;
+  return change / std::fmax(reference, 1.0f) * 60000.0f / (dt_ms > 0 ? dt_ms : 1);
+}
+
+}  // namespace max44009
+}  // namespace esphome
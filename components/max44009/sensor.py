@@ -1,15 +1,17 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import sensor, i2c
+from esphome.components import bus_scheduler, bus_stats, sample_trace, sensor, i2c
 from esphome.const import (
     CONF_ID,
     CONF_MODE,
+    CONF_THRESHOLD,
     DEVICE_CLASS_ILLUMINANCE,
     STATE_CLASS_MEASUREMENT,
     UNIT_LUX,
 )
 
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["bus_stats", "sample_trace"]
 
 max44009_ns = cg.esphome_ns.namespace("max44009")
 MAX44009Sensor = max44009_ns.class_(
@@ -21,9 +23,47 @@ MODE_OPTIONS = {
     "auto": MAX44009Mode.MAX44009_MODE_AUTO,
     "low_power": MAX44009Mode.MAX44009_MODE_LOW_POWER,
     "continuous": MAX44009Mode.MAX44009_MODE_CONTINUOUS,
+    "adaptive": MAX44009Mode.MAX44009_MODE_ADAPTIVE,
 }
 
-CONFIG_SCHEMA = (
+CONF_ADAPTIVE = "adaptive"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
+CONF_STABLE_SAMPLES = "stable_samples"
+CONF_DEADBAND = "deadband"
+
+ADAPTIVE_SCHEMA = cv.Schema(
+    {
+        # the mode follows the interval as in auto mode: continuous below 800ms, so a
+        # min_interval of 800ms or more keeps the sensor in low power mode
+        cv.Optional(
+            CONF_MIN_INTERVAL, default="500ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_MAX_INTERVAL, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_THRESHOLD, default="20%"): cv.percentage,
+        # absolute lux change that counts as stable whatever the relative change
+        cv.Optional(CONF_DEADBAND, default=2.0): cv.positive_float,
+        cv.Optional(CONF_STABLE_SAMPLES, default=3): cv.int_range(min=1, max=255),
+    }
+)
+
+
+def validate_adaptive(config):
+    if config[CONF_MODE] != "adaptive":
+        if CONF_ADAPTIVE in config:
+            raise cv.Invalid("adaptive options require mode: adaptive")
+        return config
+    if CONF_ADAPTIVE not in config:
+        config[CONF_ADAPTIVE] = ADAPTIVE_SCHEMA({})
+    adaptive = config[CONF_ADAPTIVE]
+    if adaptive[CONF_MIN_INTERVAL] > adaptive[CONF_MAX_INTERVAL]:
+        raise cv.Invalid("min_interval must not be longer than max_interval")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
     sensor.sensor_schema(
         unit_of_measurement=UNIT_LUX,
         accuracy_decimals=0,
@@ -34,10 +74,19 @@ CONFIG_SCHEMA = (
         {
             cv.GenerateID(): cv.declare_id(MAX44009Sensor),
             cv.Optional(CONF_MODE, default="auto"): cv.enum(MODE_OPTIONS, upper=False),
+            cv.Optional(CONF_ADAPTIVE): ADAPTIVE_SCHEMA,
+            cv.Optional(bus_stats.CONF_BUS_STATS): bus_stats.BUS_STATS_SCHEMA,
+            cv.Optional(
+                sample_trace.CONF_TRACE_SIZE, default=0
+            ): sample_trace.TRACE_SIZE_SCHEMA,
+            cv.Optional(bus_scheduler.CONF_BUS_SCHEDULER_ID): cv.use_id(
+                bus_scheduler.BusScheduler
+            ),
         }
     )
     .extend(cv.polling_component_schema("60s"))
-    .extend(i2c.i2c_device_schema(0x4A))
+    .extend(i2c.i2c_device_schema(0x4A)),
+    validate_adaptive,
 )
 
 
@@ -46,5 +95,23 @@ async def to_code(config):
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
     await sensor.register_sensor(var, config)
+    cg.add(var.set_trace_size(config[sample_trace.CONF_TRACE_SIZE]))
 
     cg.add(var.set_mode(config[CONF_MODE]))
+    if CONF_ADAPTIVE in config:
+        adaptive = config[CONF_ADAPTIVE]
+        cg.add(
+            var.set_adaptive(
+                adaptive[CONF_MIN_INTERVAL],
+                adaptive[CONF_MAX_INTERVAL],
+                adaptive[CONF_THRESHOLD],
+                adaptive[CONF_DEADBAND],
+                adaptive[CONF_STABLE_SAMPLES],
+            )
+        )
+
+    if bus_stats.CONF_BUS_STATS in config:
+        stats = await bus_stats.new_bus_stats(config[bus_stats.CONF_BUS_STATS])
+        cg.add(var.set_bus_stats(stats))
+
+    await bus_scheduler.register_bus_client(var, config)
@@ -1,28 +1,130 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import i2c
-from esphome.const import CONF_ID
+import esphome.final_validate as fv
+from esphome import pins
+from esphome.components import bus_scheduler, bus_stats, i2c
+from esphome.const import CONF_ADDRESS, CONF_ID, CONF_SCL, CONF_SDA
 
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["bus_stats"]
 MULTI_CONF = True
 CONF_EEPROM = "eeprom"
+CONF_LDAC_PIN = "ldac_pin"
+CONF_LDAC_TIED_LOW = "ldac_tied_low"
+CONF_SYNC_WITH = "sync_with"
+CONF_PROGRAM_ADDRESS = "program_address"
+CONF_FROM_ADDRESS = "from_address"
+CONF_IDLE_POWER_DOWN = "idle_power_down"
+DOMAIN = "mcp4728"
 
 mcp4728_ns = cg.esphome_ns.namespace("mcp4728")
 MCP4728Output = mcp4728_ns.class_("MCP4728Output", cg.Component, i2c.I2CDevice)
+MCP4728AddressProgrammer = mcp4728_ns.class_("MCP4728AddressProgrammer", cg.Component)
 
-CONFIG_SCHEMA = (
+PowerDown = mcp4728_ns.enum("PWR_DOWN", is_class=True)
+POWER_DOWN_OPTIONS = {
+    "none": PowerDown.NORMAL,
+    "1k": PowerDown.GND_1KOHM,
+    "100k": PowerDown.GND_100KOHM,
+    "500k": PowerDown.GND_500KOHM,
+}
+
+PROGRAM_ADDRESS_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(MCP4728AddressProgrammer),
+        cv.Required(CONF_SDA): pins.gpio_output_pin_schema,
+        cv.Required(CONF_SCL): pins.gpio_output_pin_schema,
+        cv.Optional(CONF_FROM_ADDRESS, default=0x60): cv.i2c_address,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+def validate_ldac_tied_low(config):
+    if not config[CONF_LDAC_TIED_LOW]:
+        return config
+    for key in (CONF_LDAC_PIN, CONF_SYNC_WITH):
+        if key in config:
+            raise cv.Invalid(f"{CONF_LDAC_TIED_LOW} can't be used with {key}, LDAC is driven then")
+    return config
+
+
+def validate_program_address(config):
+    if CONF_PROGRAM_ADDRESS not in config:
+        return config
+    if CONF_LDAC_PIN not in config:
+        raise cv.Invalid(f"{CONF_PROGRAM_ADDRESS} requires {CONF_LDAC_PIN}")
+    if config[CONF_PROGRAM_ADDRESS][CONF_FROM_ADDRESS] == config[CONF_ADDRESS]:
+        raise cv.Invalid(f"{CONF_FROM_ADDRESS} must differ from {CONF_ADDRESS}")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(MCP4728Output),
-            cv.Optional(CONF_EEPROM, default=False): cv.boolean
+            cv.Optional(CONF_EEPROM, default=False): cv.boolean,
+            cv.Optional(CONF_IDLE_POWER_DOWN, default="none"): cv.enum(
+                POWER_DOWN_OPTIONS, lower=True
+            ),
+            cv.Optional(CONF_LDAC_PIN): pins.gpio_output_pin_schema,
+            cv.Optional(CONF_LDAC_TIED_LOW, default=False): cv.boolean,
+            cv.Optional(CONF_SYNC_WITH): cv.use_id(MCP4728Output),
+            cv.Optional(CONF_PROGRAM_ADDRESS): PROGRAM_ADDRESS_SCHEMA,
+            cv.Optional(bus_stats.CONF_BUS_STATS): bus_stats.BUS_STATS_SCHEMA,
+            cv.Optional(bus_scheduler.CONF_BUS_SCHEDULER_ID): cv.use_id(
+                bus_scheduler.BusScheduler
+            ),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
-    .extend(i2c.i2c_device_schema(0x60))
+    .extend(i2c.i2c_device_schema(0x60)),
+    validate_ldac_tied_low,
+    validate_program_address,
 )
 
 
+def final_validate_sync_with(config):
+    # only the group owner flushes its followers, so groups are one level deep
+    if CONF_SYNC_WITH not in config:
+        return config
+    leader_id = config[CONF_SYNC_WITH]
+    if leader_id == config[CONF_ID]:
+        raise cv.Invalid(f"{CONF_SYNC_WITH} must refer to another DAC")
+    for conf in fv.full_config.get()[DOMAIN]:
+        if conf[CONF_ID] == leader_id and CONF_SYNC_WITH in conf:
+            raise cv.Invalid(
+                f"{CONF_SYNC_WITH} must refer to the DAC owning the group, "
+                f"'{leader_id}' itself uses {CONF_SYNC_WITH}"
+            )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = final_validate_sync_with
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID], config[CONF_EEPROM])
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
+    if bus_stats.CONF_BUS_STATS in config:
+        stats = await bus_stats.new_bus_stats(config[bus_stats.CONF_BUS_STATS])
+        cg.add(var.set_bus_stats(stats))
+    await bus_scheduler.register_bus_client(var, config)
+    cg.add(var.set_idle_power_down(config[CONF_IDLE_POWER_DOWN]))
+    if CONF_LDAC_PIN in config:
+        ldac = await cg.gpio_pin_expression(config[CONF_LDAC_PIN])
+        cg.add(var.set_ldac_pin(ldac))
+    cg.add(var.set_ldac_tied_low(config[CONF_LDAC_TIED_LOW]))
+    if CONF_SYNC_WITH in config:
+        leader = await cg.get_variable(config[CONF_SYNC_WITH])
+        cg.add(var.set_sync_leader(leader))
+    if CONF_PROGRAM_ADDRESS in config:
+        conf = config[CONF_PROGRAM_ADDRESS]
+        prog = cg.new_Pvariable(
+            conf[CONF_ID], var, conf[CONF_FROM_ADDRESS], config[CONF_ADDRESS]
+        )
+        await cg.register_component(prog, conf)
+        sda = await cg.gpio_pin_expression(conf[CONF_SDA])
+        cg.add(prog.set_sda_pin(sda))
+        scl = await cg.gpio_pin_expression(conf[CONF_SCL])
+        cg.add(prog.set_scl_pin(scl))
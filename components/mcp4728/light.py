@@ -0,0 +1,116 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import light
+from esphome.const import (
+    CONF_BLUE,
+    CONF_COLD_WHITE,
+    CONF_COLD_WHITE_COLOR_TEMPERATURE,
+    CONF_CONSTANT_BRIGHTNESS,
+    CONF_GAIN,
+    CONF_GREEN,
+    CONF_ID,
+    CONF_OUTPUT_ID,
+    CONF_RED,
+    CONF_TYPE,
+    CONF_WARM_WHITE,
+    CONF_WARM_WHITE_COLOR_TEMPERATURE,
+    CONF_WHITE,
+)
+from . import MCP4728Output, mcp4728_ns
+from .output import (
+    CHANNEL_OPTIONS,
+    CONF_MCP4728_ID,
+    CONF_VREF,
+    GAIN_OPTIONS,
+    VREF_OPTIONS,
+    validate_channel_unused,
+)
+
+DEPENDENCIES = ["mcp4728"]
+
+MCP4728LightOutput = mcp4728_ns.class_("MCP4728LightOutput", light.LightOutput)
+MCP4728LightType = mcp4728_ns.enum("MCP4728LightType")
+
+# channels of each light type, in the order the light output expects them
+LIGHT_TYPES = {
+    "rgb": (MCP4728LightType.MCP4728_LIGHT_RGB, [CONF_RED, CONF_GREEN, CONF_BLUE]),
+    "rgbw": (
+        MCP4728LightType.MCP4728_LIGHT_RGBW,
+        [CONF_RED, CONF_GREEN, CONF_BLUE, CONF_WHITE],
+    ),
+    "cwww": (MCP4728LightType.MCP4728_LIGHT_CWWW, [CONF_COLD_WHITE, CONF_WARM_WHITE]),
+}
+
+
+def validate_channels(config):
+    channels = [str(config[key]) for key in LIGHT_TYPES[config[CONF_TYPE]][1]]
+    if len(set(channels)) != len(channels):
+        raise cv.Invalid("Each color must use a different channel")
+    return config
+
+
+def light_schema(keys, extra=None):
+    schema = light.RGB_LIGHT_SCHEMA.extend(
+        {
+            cv.GenerateID(CONF_OUTPUT_ID): cv.declare_id(MCP4728LightOutput),
+            cv.GenerateID(CONF_MCP4728_ID): cv.use_id(MCP4728Output),
+            cv.Optional(CONF_VREF, default="vdd"): cv.enum(VREF_OPTIONS, upper=False),
+            cv.Optional(CONF_GAIN, default="X1"): cv.enum(GAIN_OPTIONS, upper=True),
+        }
+    ).extend(
+        {cv.Required(key): cv.enum(CHANNEL_OPTIONS, upper=True) for key in keys}
+    )
+    if extra is not None:
+        schema = schema.extend(extra)
+    return schema
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.typed_schema(
+        {
+            "rgb": light_schema(LIGHT_TYPES["rgb"][1]),
+            "rgbw": light_schema(LIGHT_TYPES["rgbw"][1]),
+            "cwww": light_schema(
+                LIGHT_TYPES["cwww"][1],
+                {
+                    cv.Optional(
+                        CONF_COLD_WHITE_COLOR_TEMPERATURE, default="6536K"
+                    ): cv.color_temperature,
+                    cv.Optional(
+                        CONF_WARM_WHITE_COLOR_TEMPERATURE, default="2000K"
+                    ): cv.color_temperature,
+                    cv.Optional(CONF_CONSTANT_BRIGHTNESS, default=False): cv.boolean,
+                },
+            ),
+        },
+        key=CONF_TYPE,
+        lower=True,
+    ),
+    validate_channels,
+)
+
+
+def final_validate_channels(config):
+    for key in LIGHT_TYPES[config[CONF_TYPE]][1]:
+        validate_channel_unused(config[CONF_MCP4728_ID], str(config[key]), config[CONF_ID])
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = final_validate_channels
+
+
+async def to_code(config):
+    paren = await cg.get_variable(config[CONF_MCP4728_ID])
+    light_type, keys = LIGHT_TYPES[config[CONF_TYPE]]
+    var = cg.new_Pvariable(config[CONF_OUTPUT_ID], paren, light_type)
+    await light.register_light(var, config)
+    for key in keys:
+        cg.add(var.add_channel(config[key], config[CONF_VREF], config[CONF_GAIN]))
+    if config[CONF_TYPE] == "cwww":
+        cg.add(
+            var.set_color_temperatures(
+                config[CONF_COLD_WHITE_COLOR_TEMPERATURE],
+                config[CONF_WARM_WHITE_COLOR_TEMPERATURE],
+            )
+        )
+        cg.add(var.set_constant_brightness(config[CONF_CONSTANT_BRIGHTNESS]))
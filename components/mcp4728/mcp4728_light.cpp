@@ -0,0 +1,51 @@
+#include "mcp4728_light.h"
+
+#ifdef USE_LIGHT
+
+namespace esphome {
+namespace mcp4728 {
+
+void MCP4728LightOutput::add_channel(MCP4728_CHANNEL channel, MCP4728_VREF vref, MCP4728_GAIN gain) {
+  this->channels_[this->channel_count_++] = channel;
+  this->parent_->add_light_channel(channel, vref, gain);
+}
+
+light::LightTraits MCP4728LightOutput::get_traits() {
+  auto traits = light::LightTraits();
+  switch (this->type_) {
+    case MCP4728_LIGHT_RGB:
+      traits.set_supported_color_modes({light::ColorMode::RGB});
+      break;
+    case MCP4728_LIGHT_RGBW:
+      traits.set_supported_color_modes({light::ColorMode::RGB_WHITE});
+      break;
+    case MCP4728_LIGHT_CWWW:
+      traits.set_supported_color_modes({light::ColorMode::COLD_WARM_WHITE});
+      traits.set_min_mireds(this->cold_white_mireds_);
+      traits.set_max_mireds(this->warm_white_mireds_);
+      break;
+  }
+  return traits;
+}
+
+void MCP4728LightOutput::write_state(light::LightState *state) {
+  float values[4];
+  switch (this->type_) {
+    case MCP4728_LIGHT_RGB:
+      state->current_values_as_rgb(&values[0], &values[1], &values[2]);
+      break;
+    case MCP4728_LIGHT_RGBW:
+      state->current_values_as_rgbw(&values[0], &values[1], &values[2], &values[3]);
+      break;
+    case MCP4728_LIGHT_CWWW:
+      state->current_values_as_cwww(&values[0], &values[1], this->constant_brightness_);
+      break;
+  }
+  // unchanged channels are skipped, the rest go out in one transaction on the next loop
+  this->parent_->set_light_values(this->channels_, values, this->channel_count_);
+}
+
+}  // namespace mcp4728
+}  // namespace esphome
+
+#endif  // USE_LIGHT
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_LIGHT
+
+#include "esphome/components/light/light_output.h"
+#include "mcp4728_output.h"
+
+namespace esphome {
+namespace mcp4728 {
+
+enum MCP4728LightType { MCP4728_LIGHT_RGB, MCP4728_LIGHT_RGBW, MCP4728_LIGHT_CWWW };
+
+/// Multi-channel light on one MCP4728.
+///
+/// Every channel of a light state is handed to the DAC at once, so the next loop writes them
+/// in a single I2C transaction and a colour is never applied halfway. Transitions are stepped
+/// by the light state, one write per step.
+class MCP4728LightOutput : public light::LightOutput {
+ public:
+  MCP4728LightOutput(MCP4728Output *parent, MCP4728LightType type) : parent_(parent), type_(type) {}
+
+  /// Channels in colour order: red, green, blue (, white) or cold white, warm white.
+  void add_channel(MCP4728_CHANNEL channel, MCP4728_VREF vref, MCP4728_GAIN gain);
+  void set_color_temperatures(float cold_white_mireds, float warm_white_mireds) {
+    cold_white_mireds_ = cold_white_mireds;
+    warm_white_mireds_ = warm_white_mireds;
+  }
+  void set_constant_brightness(bool constant_brightness) { constant_brightness_ = constant_brightness; }
+
+  light::LightTraits get_traits() override;
+  void write_state(light::LightState *state) override;
+
+ protected:
+  MCP4728Output *parent_;
+  MCP4728LightType type_;
+  MCP4728_CHANNEL channels_[4];
+  uint8_t channel_count_ = 0;
+  float cold_white_mireds_ = 153;
+  float warm_white_mireds_ = 500;
+  bool constant_brightness_ = false;
+};
+
+}  // namespace mcp4728
+}  // namespace esphome
+
+#endif  // USE_LIGHT
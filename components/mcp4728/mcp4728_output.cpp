@@ -3,33 +3,223 @@
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+
 namespace esphome {
 namespace mcp4728 {
 
 static const char *const TAG = "mcp4728";
 
+// back-off between retries of a failed write, doubled on each failure
+static const uint32_t RETRY_DELAY_MIN = 10;
+static const uint32_t RETRY_DELAY_MAX = 5000;
+
 void MCP4728Output::setup() {
   ESP_LOGCONFIG(TAG, "Setting up MCP4728OutputComponent...");
+  if (this->ldac_pin_ != nullptr) {
+    // keep LDAC high so writes wait for a latch pulse
+    this->ldac_pin_->setup();
+    this->ldac_pin_->digital_write(true);
+  }
+  this->staged_ = this->ldac_pin_ != nullptr ||
+                  (this->sync_leader_ != nullptr && this->sync_leader_->ldac_pin_ != nullptr);
+  if (!this->readBack()) {
+    this->error_code_ = COMMUNICATION_FAILED;
+    this->mark_failed();
+    return;
+  }
+}
+
+bool MCP4728Output::readBack() {
+  // 4 channels x (DAC input register + EEPROM), 3 bytes each
+  uint8_t rd[24];
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  i2c::ErrorCode err = this->read(rd, sizeof(rd));
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, sizeof(rd) + 1, err == i2c::ERROR_OK);
+  if (err != i2c::ERROR_OK)
+    return false;
+
+  this->dirty_ = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    DACInputData chip[2];
+    for (uint8_t r = 0; r < 2; r++) {
+      const uint8_t *b = &rd[i * 6 + r * 3];
+      chip[r].vref = (MCP4728_VREF)(b[1] >> 7);
+      chip[r].pd = (PWR_DOWN)((b[1] >> 5) & 0x03);
+      chip[r].gain = (MCP4728_GAIN)((b[1] >> 4) & 0x01);
+      chip[r].data = ((b[1] & 0x0F) << 8) | b[2];
+    }
+    ESP_LOGD(TAG, "Channel %c: DAC vref=%d pd=%d gain=%d data=%d, EEPROM vref=%d pd=%d gain=%d data=%d", 'A' + i,
+             chip[0].vref, (uint8_t) chip[0].pd, chip[0].gain, chip[0].data, chip[1].vref, (uint8_t) chip[1].pd,
+             chip[1].gain, chip[1].data);
+
+    if ((this->configured_ & (1 << i)) == 0) {
+      // leave channels without an output as they are, unless they should be powered down
+      this->reg_[i] = chip[0];
+      if (this->idle_pd_ == PWR_DOWN::NORMAL)
+        continue;
+      this->reg_[i].pd = this->idle_pd_;
+    }
+    // keep the current level, only write channels whose configuration differs
+    this->reg_[i].data = chip[0].data;
+    this->reg_[i].pd = this->power_down_for_(i, chip[0].data);
+    const uint8_t last = this->eeprom ? 2 : 1;
+    for (uint8_t r = 0; r < last; r++) {
+      if (chip[r].vref != this->reg_[i].vref || chip[r].pd != this->reg_[i].pd || chip[r].gain != this->reg_[i].gain)
+        this->dirty_ |= 1 << i;
+    }
+  }
+  this->config_dirty_ = this->dirty_;
+  return true;
 }
 
 void MCP4728Output::dump_config() {
   ESP_LOGCONFIG(TAG, "MCP4728:");
   LOG_I2C_DEVICE(this);
+  LOG_PIN("  LDAC Pin: ", this->ldac_pin_);
+  if (this->idle_pd_ != PWR_DOWN::NORMAL) {
+    static const char *const PD_NAMES[] = {"normal", "1k", "100k", "500k"};
+    ESP_LOGCONFIG(TAG, "  Idle power down: %s to GND", PD_NAMES[(uint8_t) this->idle_pd_]);
+  }
+  if (this->sync_leader_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Latched by the DAC at address 0x%02X", this->sync_leader_->address_);
+  } else if (!this->sync_followers_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Latches %zu other DACs", this->sync_followers_.size());
+  }
+  if (this->bus_stats_ != nullptr) {
+    this->bus_stats_->log_stats(TAG);
+  }
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with MCP4728 failed!");
+  } else if (this->write_errors_ > 0) {
+    ESP_LOGW(TAG, "  %u failed writes", this->write_errors_);
   }
 }
 
+void MCP4728Output::set_sync_leader(MCP4728Output *leader) {
+  this->sync_leader_ = leader;
+  leader->sync_followers_.push_back(this);
+}
+
 void MCP4728Output::loop() {
-  if (this->update) {
-    this->update = false;
-    if (this->eeprom)
-      this->seqWrite();
-    else
-      this->multiWrite();
+  // the group leader flushes and latches its followers
+  if (this->sync_leader_ != nullptr) {
+    if (!this->sync_leader_->is_failed())
+      return;
+    // a failed leader never pulses the LDAC line this DAC shares with it, update the outputs directly
+    this->staged_ = this->ldac_pin_ != nullptr;
+  }
+  if (this->group_dirty_()) {
+#ifdef USE_BUS_SCHEDULER
+    if (this->bus_scheduler_ != nullptr) {
+      // actuator writes go ahead of queued sensor transactions
+      if (!this->flush_pending_) {
+        this->flush_pending_ = true;
+        this->bus_scheduler_->submit(bus_scheduler::BUS_PRIORITY_ACTUATOR, [this]() -> uint32_t {
+          this->flush_pending_ = false;
+          this->flush_group_();
+          return bus_scheduler::BUS_JOB_DONE;
+        });
+      }
+      return;
+    }
+#endif
+    this->flush_group_();
+  }
+}
+
+bool MCP4728Output::group_dirty_() const {
+  if (this->dirty_ != 0)
+    return true;
+  for (auto *follower : this->sync_followers_) {
+    if (follower->dirty_ != 0 && !follower->is_failed())
+      return true;
+  }
+  return false;
+}
+
+void MCP4728Output::flush_group_() {
+  bool written = false;
+  if (this->dirty_ != 0)
+    written |= this->flush_();
+  for (auto *follower : this->sync_followers_) {
+    if (follower->dirty_ != 0 && !follower->is_failed())
+      written |= follower->flush_();
+  }
+  if (written)
+    this->latch_group_();
+}
+
+void MCP4728Output::latch_group_() {
+  // a falling edge on LDAC moves the input registers to the outputs
+  bool pulsed = false;
+  if (this->ldac_pin_ != nullptr) {
+    this->ldac_pin_->digital_write(false);
+    pulsed = true;
+  }
+  for (auto *follower : this->sync_followers_) {
+    if (follower->ldac_pin_ != nullptr) {
+      follower->ldac_pin_->digital_write(false);
+      pulsed = true;
+    }
+  }
+  if (!pulsed)
+    return;
+  delayMicroseconds(1);
+  if (this->ldac_pin_ != nullptr)
+    this->ldac_pin_->digital_write(true);
+  for (auto *follower : this->sync_followers_) {
+    if (follower->ldac_pin_ != nullptr)
+      follower->ldac_pin_->digital_write(true);
   }
 }
 
+uint8_t MCP4728Output::udac_() const { return this->staged_ ? 0x01 : 0x00; }
+
+PWR_DOWN MCP4728Output::power_down_for_(uint8_t channel, uint16_t data) const {
+  if (this->idle_pd_ == PWR_DOWN::NORMAL)
+    return PWR_DOWN::NORMAL;
+  if ((this->configured_ & (1 << channel)) == 0 || data == 0)
+    return this->idle_pd_;
+  return PWR_DOWN::NORMAL;
+}
+
+bool MCP4728Output::flush_() {
+  if (this->retry_delay_ != 0 && (int32_t)(millis() - this->retry_at_) < 0)
+    return false;
+  i2c::ErrorCode err;
+  if (this->eeprom) {
+    err = this->seqWrite();
+  } else if ((this->staged_ || this->ldac_tied_low_) && this->config_dirty_ == 0 &&
+             __builtin_popcount(this->dirty_) >= 3) {
+    // cheaper than a multi write from 3 channels on, when only levels changed and something
+    // moves the input registers to the outputs
+    err = this->fastWrite();
+  } else {
+    err = this->multiWrite();
+  }
+  if (err == i2c::ERROR_OK) {
+    if (this->error_code_ != NONE) {
+      ESP_LOGI(TAG, "Write recovered");
+      this->error_code_ = NONE;
+      this->status_clear_warning();
+    }
+    this->retry_delay_ = 0;
+    return true;
+  }
+  // nothing reached the input registers, so there is nothing to latch either
+  this->write_errors_++;
+  this->retry_delay_ = this->retry_delay_ == 0 ? RETRY_DELAY_MIN : std::min(this->retry_delay_ * 2, RETRY_DELAY_MAX);
+  this->retry_at_ = millis() + this->retry_delay_;
+  if (this->error_code_ == NONE) {
+    ESP_LOGW(TAG, "Write failed (error %d), retrying channels 0x%X", err, this->dirty_);
+    this->error_code_ = COMMUNICATION_FAILED;
+    this->status_set_warning();
+  }
+  return false;
+}
+
 void MCP4728Output::set_channel_value(MCP4728_CHANNEL channel, uint16_t value) {
   uint8_t cn = 0;
   if (channel == MCP4728_CHANNEL_A)
@@ -40,60 +230,243 @@ void MCP4728Output::set_channel_value(MCP4728_CHANNEL channel, uint16_t value) {
     cn = 'C';
   else
     cn = 'D';
+  // power down at zero and wake up in the same write
+  const PWR_DOWN pd = this->power_down_for_(channel, value);
+  if (value == reg_[channel].data && pd == reg_[channel].pd)
+    return;
   ESP_LOGD(TAG, "Setting MCP4728 channel %c to %d!", cn, value);
   reg_[channel].data = value;
-  this->update = true;
+  reg_[channel].pd = pd;
+  this->dirty_ |= 1 << channel;
 }
 
-uint8_t MCP4728Output::multiWrite() {
+void MCP4728Output::set_light_values(const MCP4728_CHANNEL *channels, const float *values, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++)
+    this->set_channel_value(channels[i], static_cast<uint16_t>(roundf(clamp(values[i], 0.0f, 1.0f) * 4095)));
+}
+
+i2c::ErrorCode MCP4728Output::multiWrite() {
+  // every dirty channel in one transaction, so they change together
+  uint8_t wd[12];
+  uint8_t len = 0;
+  uint8_t written = 0;
   for (uint8_t i = 0; i < 4; ++i) {
-    uint8_t wd[3];
-    wd[0] = ((uint8_t)CMD::MULTI_WRITE | (i << 1)) & 0xFE;
-    wd[1] = ((uint8_t)reg_[i].vref << 7) | ((uint8_t)reg_[i].pd << 5) |
-            ((uint8_t)reg_[i].gain << 4) | highByte(reg_[i].data);
-    wd[2] = lowByte(reg_[i].data);
-    this->write(wd, sizeof(wd));
+    if ((this->dirty_ & (1 << i)) == 0)
+      continue;
+    wd[len++] = (uint8_t)CMD::MULTI_WRITE | (i << 1) | this->udac_();
+    wd[len++] = ((uint8_t)reg_[i].vref << 7) | ((uint8_t)reg_[i].pd << 5) |
+                ((uint8_t)reg_[i].gain << 4) | highByte(reg_[i].data);
+    wd[len++] = lowByte(reg_[i].data);
+    written |= 1 << i;
+  }
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  i2c::ErrorCode err = this->write(wd, len);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, len + 1, err == i2c::ERROR_OK);
+  if (err == i2c::ERROR_OK) {
+    this->dirty_ &= ~written;
+    this->config_dirty_ &= ~written;
   }
-  return 0;
+  return err;
 }
 
-uint8_t MCP4728Output::seqWrite() {
-  uint8_t wd[9];
-  wd[0] = (uint8_t)CMD::SEQ_WRITE;
+i2c::ErrorCode MCP4728Output::fastWrite() {
+  uint8_t wd[8];
   for (uint8_t i = 0; i < 4; i++) {
-    wd[i * 2 + 1] = ((uint8_t)reg_[i].vref << 7) | ((uint8_t)reg_[i].pd << 5) |
-                    ((uint8_t)reg_[i].gain << 4) | highByte(reg_[i].data);
-    wd[i * 2 + 2] = lowByte(reg_[i].data);
+    wd[i * 2] = (uint8_t)CMD::FAST_WRITE | ((uint8_t)reg_[i].pd << 4) | highByte(reg_[i].data);
+    wd[i * 2 + 1] = lowByte(reg_[i].data);
+  }
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  i2c::ErrorCode err = this->write(wd, sizeof(wd));
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, sizeof(wd) + 1, err == i2c::ERROR_OK);
+  if (err == i2c::ERROR_OK)
+    this->dirty_ = 0;
+  return err;
+}
+
+i2c::ErrorCode MCP4728Output::seqWrite() {
+  // sequential write always runs up to channel D, start at the first dirty channel
+  uint8_t first = 0;
+  while (first < 3 && (this->dirty_ & (1 << first)) == 0)
+    first++;
+  uint8_t wd[9];
+  uint8_t len = 1;
+  wd[0] = (uint8_t)CMD::SEQ_WRITE | (first << 1) | this->udac_();
+  for (uint8_t i = first; i < 4; i++) {
+    wd[len++] = ((uint8_t)reg_[i].vref << 7) | ((uint8_t)reg_[i].pd << 5) |
+                ((uint8_t)reg_[i].gain << 4) | highByte(reg_[i].data);
+    wd[len++] = lowByte(reg_[i].data);
+  }
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  i2c::ErrorCode err = this->write(wd, len);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, len + 1, err == i2c::ERROR_OK);
+  if (err == i2c::ERROR_OK) {
+    this->dirty_ = 0;
+    this->config_dirty_ = 0;
   }
-  this->write(wd, sizeof(wd));
-  return 0;
+  return err;
 }
 
 void MCP4728Output::selectVref(MCP4728_CHANNEL channel, MCP4728_VREF vref) {
   reg_[channel].vref = vref;
 
-  this->update = true;
+  this->dirty_ |= 1 << channel;
+  this->config_dirty_ |= 1 << channel;
 }
 
 void MCP4728Output::selectPowerDown(MCP4728_CHANNEL channel, PWR_DOWN pd) {
   reg_[channel].pd = pd;
 
-  this->update = true;
+  this->dirty_ |= 1 << channel;
+  this->config_dirty_ |= 1 << channel;
 }
 
 void MCP4728Output::selectGain(MCP4728_CHANNEL channel, MCP4728_GAIN gain) {
   reg_[channel].gain = gain;
 
-  this->update = true;
+  this->dirty_ |= 1 << channel;
+  this->config_dirty_ |= 1 << channel;
 }
 
 MCP4728Channel *MCP4728Output::create_channel(MCP4728_CHANNEL channel,
                                               MCP4728_VREF vref,
                                               MCP4728_GAIN gain) {
   auto *c = new MCP4728Channel(this, channel, vref, gain);
+  this->configured_ |= 1 << channel;
   return c;
 }
 
+void MCP4728Output::add_light_channel(MCP4728_CHANNEL channel, MCP4728_VREF vref, MCP4728_GAIN gain) {
+  this->selectVref(channel, vref);
+  this->selectPowerDown(channel, PWR_DOWN::NORMAL);
+  this->selectGain(channel, gain);
+  this->configured_ |= 1 << channel;
+}
+
+void MCP4728AddressProgrammer::setup() {
+  GPIOPin *ldac = this->parent_->get_ldac_pin();
+  ldac->setup();
+  ldac->digital_write(true);
+  this->sda_pin_->setup();
+  this->scl_pin_->setup();
+  this->sda_(true);
+  this->scl_(true);
+
+  if (this->probe_(this->to_address_)) {
+    this->result_ = ALREADY_SET;
+  } else if (!this->probe_(this->from_address_)) {
+    this->result_ = NOT_FOUND;
+  } else if (!this->program_()) {
+    this->result_ = FAILED;
+  } else {
+    // the new address is stored in EEPROM, wait for the write to complete
+    uint32_t start = millis();
+    while (!this->probe_(this->to_address_) && millis() - start < 100)
+      delay(5);
+    this->result_ = this->probe_(this->to_address_) ? PROGRAMMED : FAILED;
+  }
+
+  // hand the pins back to the I2C bus
+  this->sda_(true);
+  this->scl_(true);
+}
+
+void MCP4728AddressProgrammer::dump_config() {
+  ESP_LOGCONFIG(TAG, "MCP4728 address programming 0x%02X -> 0x%02X:", this->from_address_, this->to_address_);
+  LOG_PIN("  SDA Pin: ", this->sda_pin_);
+  LOG_PIN("  SCL Pin: ", this->scl_pin_);
+  switch (this->result_) {
+    case ALREADY_SET:
+      ESP_LOGCONFIG(TAG, "  Address already set");
+      break;
+    case PROGRAMMED:
+      ESP_LOGCONFIG(TAG, "  Address programmed");
+      break;
+    case NOT_FOUND:
+      ESP_LOGW(TAG, "  No MCP4728 found at 0x%02X or 0x%02X", this->from_address_, this->to_address_);
+      break;
+    case FAILED:
+      ESP_LOGE(TAG, "  Programming the address failed");
+      break;
+    default:
+      break;
+  }
+}
+
+// Open-drain emulation: release the line to let the pull-up take it high
+void MCP4728AddressProgrammer::sda_(bool high) {
+  if (high) {
+    this->sda_pin_->pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+  } else {
+    this->sda_pin_->pin_mode(gpio::FLAG_OUTPUT);
+    this->sda_pin_->digital_write(false);
+  }
+  delayMicroseconds(5);
+}
+
+void MCP4728AddressProgrammer::scl_(bool high) {
+  if (high) {
+    this->scl_pin_->pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+  } else {
+    this->scl_pin_->pin_mode(gpio::FLAG_OUTPUT);
+    this->scl_pin_->digital_write(false);
+  }
+  delayMicroseconds(5);
+}
+
+void MCP4728AddressProgrammer::start_() {
+  this->sda_(true);
+  this->scl_(true);
+  this->sda_(false);
+  this->scl_(false);
+}
+
+void MCP4728AddressProgrammer::stop_() {
+  this->sda_(false);
+  this->scl_(true);
+  this->sda_(true);
+}
+
+bool MCP4728AddressProgrammer::write_byte_(uint8_t data, bool ldac_low) {
+  for (uint8_t i = 0; i < 8; i++) {
+    this->sda_(data & 0x80);
+    this->scl_(true);
+    this->scl_(false);
+    data <<= 1;
+  }
+  if (ldac_low)
+    this->parent_->get_ldac_pin()->digital_write(false);
+  this->sda_(true);
+  this->scl_(true);
+  bool ack = !this->sda_pin_->digital_read();
+  this->scl_(false);
+  return ack;
+}
+
+bool MCP4728AddressProgrammer::probe_(uint8_t address) {
+  this->start_();
+  bool ack = this->write_byte_(address << 1);
+  this->stop_();
+  return ack;
+}
+
+bool MCP4728AddressProgrammer::program_() {
+  // address bits are the 3 LSBs of the 7-bit address
+  const uint8_t current = this->from_address_ & 0x07;
+  const uint8_t next = this->to_address_ & 0x07;
+  this->start_();
+  bool ack = this->write_byte_(this->from_address_ << 1);
+  // write address bits command: current, new, new (confirmation)
+  ack = ack && this->write_byte_(0x61 | (current << 2), true);
+  ack = ack && this->write_byte_(0x62 | (next << 2));
+  ack = ack && this->write_byte_(0x63 | (next << 2));
+  this->stop_();
+  this->parent_->get_ldac_pin()->digital_write(true);
+  return ack;
+}
+
 void MCP4728Channel::write_state(float state) {
   const uint16_t max_duty = 4095;
   const float duty_rounded = roundf(state * max_duty);
@@ -1,9 +1,17 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
 #include "esphome/components/output/float_output.h"
+#include "esphome/components/bus_stats/bus_stats.h"
 #include "esphome/components/i2c/i2c.h"
 #include <Arduino.h>
+#include <vector>
+
+#ifdef USE_BUS_SCHEDULER
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#endif
 
 namespace esphome {
 namespace mcp4728 {
@@ -32,10 +40,10 @@ enum MCP4728_CHANNEL {
 
 struct DACInputData
 {
-    MCP4728_VREF vref;
-    PWR_DOWN pd;
-    MCP4728_GAIN gain;
-    uint16_t data;
+    MCP4728_VREF vref = MCP4728_VREF_VDD;
+    PWR_DOWN pd = PWR_DOWN::NORMAL;
+    MCP4728_GAIN gain = MCP4728_GAIN_X1;
+    uint16_t data = 0;
 };
 
 class MCP4728Channel;
@@ -46,18 +54,49 @@ class MCP4728Output : public Component, public i2c::I2CDevice {
   MCP4728Output(bool eeprom): eeprom(eeprom) {}
 
   MCP4728Channel *create_channel(MCP4728_CHANNEL channel, MCP4728_VREF vref, MCP4728_GAIN gain);
+  /// Configure a channel driven by a light output.
+  void add_light_channel(MCP4728_CHANNEL channel, MCP4728_VREF vref, MCP4728_GAIN gain);
+  /// Set several channels at once (0.0-1.0), they are written together on the next loop.
+  void set_light_values(const MCP4728_CHANNEL *channels, const float *values, uint8_t count);
 
   void setup() override;
   void dump_config() override;
   float get_setup_priority() const override { return setup_priority::HARDWARE; }
   void loop() override;
+  void set_bus_stats(bus_stats::BusStats *bus_stats) { bus_stats_ = bus_stats; }
+  void set_ldac_pin(GPIOPin *ldac_pin) { ldac_pin_ = ldac_pin; }
+  /// LDAC is wired to GND: the outputs follow every write, Fast Write included.
+  void set_ldac_tied_low(bool ldac_tied_low) { ldac_tied_low_ = ldac_tied_low; }
+  /// Power-down mode for unconfigured channels and channels at zero, NORMAL disables it.
+  void set_idle_power_down(PWR_DOWN idle_pd) { idle_pd_ = idle_pd; }
+  GPIOPin *get_ldac_pin() const { return ldac_pin_; }
+  /// Stage writes and latch them together with the DACs of the given leader.
+  void set_sync_leader(MCP4728Output *leader);
+#ifdef USE_BUS_SCHEDULER
+  void set_bus_scheduler(bus_scheduler::BusScheduler *bus_scheduler) { bus_scheduler_ = bus_scheduler; }
+#endif
 
  protected:
   enum ErrorCode { NONE = 0, COMMUNICATION_FAILED } error_code_{NONE};
   friend MCP4728Channel;
   void set_channel_value(MCP4728_CHANNEL channel, uint16_t value);
-  uint8_t multiWrite();
-  uint8_t seqWrite();
+  // Write the dirty channels, failed channels stay dirty and are retried with back-off.
+  // Returns true if the write went through, false if it failed or waits for a retry.
+  bool flush_();
+  // Write every dirty DAC of the LDAC group, then latch them all at once
+  void flush_group_();
+  bool group_dirty_() const;
+  void latch_group_();
+  uint8_t udac_() const;
+  // Power-down mode a channel should use for the given level
+  PWR_DOWN power_down_for_(uint8_t channel, uint16_t data) const;
+  i2c::ErrorCode multiWrite();
+  i2c::ErrorCode seqWrite();
+  // All four channels without Vref/gain, 8 bytes. There is no UDAC bit, the outputs only change
+  // while LDAC is low or on the next LDAC pulse.
+  i2c::ErrorCode fastWrite();
+  // Seed reg_ from the chip's DAC registers, returns false if the read failed
+  bool readBack();
   void selectVref(MCP4728_CHANNEL channel, MCP4728_VREF vref);
   void selectPowerDown(MCP4728_CHANNEL channel, PWR_DOWN pd);
   void selectGain(MCP4728_CHANNEL channel, MCP4728_GAIN gain);
@@ -65,7 +104,61 @@ class MCP4728Output : public Component, public i2c::I2CDevice {
  private:
   DACInputData reg_[4];
   bool eeprom = false;
-  bool update = false;
+  // channels to write on the next loop, one bit per channel
+  uint8_t dirty_ = 0;
+  // channels whose Vref/gain/power-down changed since they were last written
+  uint8_t config_dirty_ = 0;
+  // channels with an output configured
+  uint8_t configured_ = 0;
+  PWR_DOWN idle_pd_ = PWR_DOWN::NORMAL;
+  GPIOPin *ldac_pin_{nullptr};
+  MCP4728Output *sync_leader_{nullptr};
+  std::vector<MCP4728Output *> sync_followers_;
+  // writes only update the input registers and wait for an LDAC pulse
+  bool staged_ = false;
+  bool ldac_tied_low_ = false;
+  // retry back-off after a failed write
+  uint32_t retry_at_ = 0;
+  uint32_t retry_delay_ = 0;
+  uint32_t write_errors_ = 0;
+  bus_stats::BusStats *bus_stats_{nullptr};
+#ifdef USE_BUS_SCHEDULER
+  bus_scheduler::BusScheduler *bus_scheduler_{nullptr};
+  bool flush_pending_ = false;
+#endif
+};
+
+/// Programs the I2C address of a MCP4728 before the I2C bus is set up.
+///
+/// The address write command needs LDAC to go low right after the 8th clock of
+/// the second byte, so the sequence is bit-banged on the bus pins.
+class MCP4728AddressProgrammer : public Component {
+ public:
+  MCP4728AddressProgrammer(MCP4728Output *parent, uint8_t from_address, uint8_t to_address)
+      : parent_(parent), from_address_(from_address), to_address_(to_address) {}
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS + 1.0f; }
+  void set_sda_pin(GPIOPin *sda_pin) { sda_pin_ = sda_pin; }
+  void set_scl_pin(GPIOPin *scl_pin) { scl_pin_ = scl_pin; }
+
+ protected:
+  void sda_(bool high);
+  void scl_(bool high);
+  void start_();
+  void stop_();
+  // Returns true if the byte was acknowledged, optionally pulling LDAC low after the 8th clock
+  bool write_byte_(uint8_t data, bool ldac_low = false);
+  bool probe_(uint8_t address);
+  bool program_();
+
+  MCP4728Output *parent_;
+  uint8_t from_address_;
+  uint8_t to_address_;
+  GPIOPin *sda_pin_{nullptr};
+  GPIOPin *scl_pin_{nullptr};
+  enum { NONE = 0, ALREADY_SET, PROGRAMMED, NOT_FOUND, FAILED } result_{NONE};
 };
 
 class MCP4728Channel : public output::FloatOutput {
@@ -1,7 +1,19 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.components import output
-from esphome.const import CONF_CHANNEL, CONF_ID, CONF_GAIN
+from esphome.const import (
+    CONF_BLUE,
+    CONF_CHANNEL,
+    CONF_COLD_WHITE,
+    CONF_GAIN,
+    CONF_GREEN,
+    CONF_ID,
+    CONF_PLATFORM,
+    CONF_RED,
+    CONF_WARM_WHITE,
+    CONF_WHITE,
+)
 from . import MCP4728Output, mcp4728_ns
 
 DEPENDENCIES = ["mcp4728"]
@@ -22,14 +34,47 @@ GAIN_OPTIONS = {
     "X2": MCP4728Gain.MCP4728_GAIN_X2
 }
 
-MCP4728Channel = mcp4728_ns.enum("MCP4728Channel")
+MCP4728ChannelIndex = mcp4728_ns.enum("MCP4728Channel")
 CHANNEL_OPTIONS = {
-    "A": MCP4728Channel.MCP4728_CHANNEL_A,
-    "B": MCP4728Channel.MCP4728_CHANNEL_B,
-    "C": MCP4728Channel.MCP4728_CHANNEL_C,
-    "D": MCP4728Channel.MCP4728_CHANNEL_D
+    "A": MCP4728ChannelIndex.MCP4728_CHANNEL_A,
+    "B": MCP4728ChannelIndex.MCP4728_CHANNEL_B,
+    "C": MCP4728ChannelIndex.MCP4728_CHANNEL_C,
+    "D": MCP4728ChannelIndex.MCP4728_CHANNEL_D
 }
 
+# light options naming a channel, for every light type
+LIGHT_CHANNEL_KEYS = [CONF_RED, CONF_GREEN, CONF_BLUE, CONF_WHITE, CONF_COLD_WHITE, CONF_WARM_WHITE]
+
+
+def _channel_users(full_config):
+    # (DAC id, channel, id of the output or light) for every channel driven by this platform
+    for conf in full_config.get("output", []):
+        if conf.get(CONF_PLATFORM) == "mcp4728":
+            yield conf[CONF_MCP4728_ID], str(conf[CONF_CHANNEL]), conf[CONF_ID]
+    for conf in full_config.get("light", []):
+        if conf.get(CONF_PLATFORM) != "mcp4728":
+            continue
+        for key in LIGHT_CHANNEL_KEYS:
+            if key in conf:
+                yield conf[CONF_MCP4728_ID], str(conf[key]), conf[CONF_ID]
+
+
+def validate_channel_unused(dac_id, channel, own_id):
+    # outputs or lights sharing a channel would fight over its level
+    for other_dac, other_channel, other_id in _channel_users(fv.full_config.get()):
+        if other_id != own_id and other_dac == dac_id and other_channel == channel:
+            raise cv.Invalid(
+                f"channel {channel} of '{dac_id}' is also driven by '{other_id}'"
+            )
+
+
+def final_validate_channel(config):
+    validate_channel_unused(
+        config[CONF_MCP4728_ID], str(config[CONF_CHANNEL]), config[CONF_ID]
+    )
+    return config
+
+
 CONFIG_SCHEMA = output.FLOAT_OUTPUT_SCHEMA.extend(
     {
         cv.Required(CONF_ID): cv.declare_id(MCP4728Channel),
@@ -46,6 +91,8 @@ CONFIG_SCHEMA = output.FLOAT_OUTPUT_SCHEMA.extend(
     }
 )
 
+FINAL_VALIDATE_SCHEMA = final_validate_channel
+
 
 async def to_code(config):
     paren = await cg.get_variable(config[CONF_MCP4728_ID])
@@ -0,0 +1,5 @@
+import esphome.config_validation as cv
+
+CONF_TRACE_SIZE = "trace_size"
+
+TRACE_SIZE_SCHEMA = cv.int_range(min=0, max=4096)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace sample_trace {
+
+static const char *const TAG = "sample_trace";
+// Samples per log line when dumping
+static const size_t SAMPLE_TRACE_LINE_SAMPLES = 8;
+
+/// Fixed-size ring of raw samples, dumped to the log as hex for tools/trace_replay.cpp.
+template<typename T> class SampleTrace {
+ public:
+  /// Allocate the ring, a capacity of 0 leaves the trace disabled.
+  void init(size_t capacity) { this->buffer_.resize(capacity); }
+  bool is_enabled() const { return !this->buffer_.empty(); }
+  size_t size() const { return this->count_; }
+
+  void push(const T &sample) {
+    if (this->buffer_.empty())
+      return;
+    this->buffer_[this->head_] = sample;
+    this->head_ = (this->head_ + 1) % this->buffer_.size();
+    if (this->count_ < this->buffer_.size())
+      this->count_++;
+  }
+
+  /// Log the samples in chronological order, framed by begin/end lines carrying name and info.
+  void dump(const char *name, const std::string &info) const {
+    ESP_LOGI(TAG, "trace %s begin size=%zu count=%zu %s", name, sizeof(T), this->count_, info.c_str());
+    const size_t capacity = this->buffer_.size();
+    size_t index = (this->head_ + capacity - this->count_) % std::max<size_t>(capacity, 1);
+    for (size_t done = 0; done < this->count_;) {
+      uint8_t line[SAMPLE_TRACE_LINE_SAMPLES * sizeof(T)];
+      size_t n = 0;
+      for (; n < SAMPLE_TRACE_LINE_SAMPLES && done < this->count_; n++, done++) {
+        memcpy(&line[n * sizeof(T)], &this->buffer_[index], sizeof(T));
+        index = (index + 1) % capacity;
+      }
+      ESP_LOGI(TAG, "trace %s: %s", name, format_hex(line, n * sizeof(T)).c_str());
+    }
+    ESP_LOGI(TAG, "trace %s end", name);
+  }
+
+ protected:
+  std::vector<T> buffer_;
+  size_t head_ = 0;
+  size_t count_ = 0;
+};
+
+}  // namespace sample_trace
+}  // namespace esphome
@@ -1,26 +1,47 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import i2c, sensor
+import esphome.final_validate as fv
+from esphome import pins
+from esphome.components import bus_scheduler, bus_stats, i2c, sample_trace, sensor
 from esphome.const import (
+    CONF_ADDRESS,
+    CONF_ENABLE_PIN,
+    CONF_FREQUENCY,
     CONF_ID,
+    CONF_INTERVAL,
     CONF_RANGE,
     CONF_GAIN,
+    CONF_I2C_ID,
     CONF_MODE,
+    CONF_PLATFORM,
+    CONF_UPDATE_INTERVAL,
     DEVICE_CLASS_ILLUMINANCE,
     STATE_CLASS_MEASUREMENT,
     UNIT_EMPTY,
+    UNIT_HERTZ,
     UNIT_LUX,
+    UNIT_PERCENT,
     ICON_BRIGHTNESS_5,
     CONF_CALCULATED_LUX,
     CONF_INFRARED,
     CONF_VISIBLE,
 )
 
+# every SI1145 powers up at this address
+DEFAULT_ADDRESS = 0x60
+
 CONF_UV_INDEX = "uv_index"
 CONF_TEMP_CORRECTION = "temp_correction"
+CONF_FLICKER = "flicker"
+CONF_SAMPLES = "samples"
+CONF_FLICKER_INDEX = "flicker_index"
+CONF_PERCENT_FLICKER = "percent_flicker"
+CONF_DELTA = "delta"
 ICON_UV = "mdi:sun-wireless"
+ICON_FLICKER = "mdi:lightbulb-alert-outline"
 
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["bus_stats", "sample_trace"]
 
 si1145_ns = cg.esphome_ns.namespace("si1145")
 
@@ -34,6 +55,50 @@ MODE_OPTIONS = {"auto": True, "manual": False}
 SI1145Range = si1145_ns.enum("SI1145Range")
 RANGE_OPTIONS = {"high": SI1145Range.RANGE_HIGH, "low": SI1145Range.RANGE_LOW}
 
+SI1145Output = si1145_ns.enum("SI1145Output")
+OUTPUTS = {
+    CONF_VISIBLE: SI1145Output.SI1145_OUTPUT_VISIBLE,
+    CONF_INFRARED: SI1145Output.SI1145_OUTPUT_INFRARED,
+    CONF_UV_INDEX: SI1145Output.SI1145_OUTPUT_UVINDEX,
+    CONF_CALCULATED_LUX: SI1145Output.SI1145_OUTPUT_ILLUMINANCE,
+}
+
+# Per output rate, defaults to the component's update_interval
+OUTPUT_SCHEDULE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_DELTA, default=0.0): cv.positive_float,
+    }
+)
+
+FLICKER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(
+            CONF_INTERVAL, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        # one sample per ms
+        cv.Optional(CONF_SAMPLES, default=256): cv.int_range(min=32, max=2048),
+        cv.Optional(CONF_FLICKER_INDEX): sensor.sensor_schema(
+            unit_of_measurement=UNIT_EMPTY,
+            accuracy_decimals=3,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=ICON_FLICKER,
+        ),
+        cv.Optional(CONF_PERCENT_FLICKER): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=ICON_FLICKER,
+        ),
+        cv.Optional(CONF_FREQUENCY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_HERTZ,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=ICON_FLICKER,
+        ),
+    }
+)
+
 CONFIG_SCHEMA = (
     cv.Schema(
         {
@@ -55,7 +120,8 @@ CONFIG_SCHEMA = (
                         RANGE_OPTIONS, upper=False
                     ),
                 }
-            ),
+            )
+            .extend(OUTPUT_SCHEDULE_SCHEMA),
             cv.Optional(CONF_INFRARED): sensor.sensor_schema(
                 unit_of_measurement=UNIT_EMPTY,
                 accuracy_decimals=0,
@@ -73,32 +139,98 @@ CONFIG_SCHEMA = (
                         RANGE_OPTIONS, upper=False
                     ),
                 }
-            ),
+            )
+            .extend(OUTPUT_SCHEDULE_SCHEMA),
             cv.Optional(CONF_UV_INDEX): sensor.sensor_schema(
                 unit_of_measurement=UNIT_EMPTY,
                 accuracy_decimals=0,
                 device_class=DEVICE_CLASS_ILLUMINANCE,
                 state_class=STATE_CLASS_MEASUREMENT,
                 icon=ICON_UV,
-            ),
+            ).extend(OUTPUT_SCHEDULE_SCHEMA),
             cv.Optional(CONF_CALCULATED_LUX): sensor.sensor_schema(
                 unit_of_measurement=UNIT_LUX,
                 accuracy_decimals=0,
                 device_class=DEVICE_CLASS_ILLUMINANCE,
                 state_class=STATE_CLASS_MEASUREMENT,
                 icon=ICON_BRIGHTNESS_5,
+            ).extend(OUTPUT_SCHEDULE_SCHEMA),
+            cv.Optional(CONF_FLICKER): FLICKER_SCHEMA,
+            cv.Optional(CONF_ENABLE_PIN): pins.gpio_output_pin_schema,
+            cv.Optional(bus_stats.CONF_BUS_STATS): bus_stats.BUS_STATS_SCHEMA,
+            cv.Optional(
+                sample_trace.CONF_TRACE_SIZE, default=0
+            ): sample_trace.TRACE_SIZE_SCHEMA,
+            cv.Optional(bus_scheduler.CONF_BUS_SCHEDULER_ID): cv.use_id(
+                bus_scheduler.BusScheduler
             ),
         }
     )
     .extend(cv.polling_component_schema("60s"))
-    .extend(i2c.i2c_device_schema(0x60))
+    .extend(i2c.i2c_device_schema(DEFAULT_ADDRESS))
 )
 
 
+def _i2c_devices(full_config):
+    # the I2C devices of every component, top level or platform
+    for confs in full_config.values():
+        for conf in confs if isinstance(confs, list) else [confs]:
+            if isinstance(conf, dict) and CONF_I2C_ID in conf and CONF_ADDRESS in conf:
+                yield conf
+
+
+def final_validate_addresses(config):
+    # Every SI1145 powers up at DEFAULT_ADDRESS. Sensors with an enable pin are powered one at a time
+    # at boot and moved to their address. The one without is powered from the start: it's moved first,
+    # before any gated sensor comes up, so it can't stay at DEFAULT_ADDRESS next to gated ones, and
+    # nothing else on the bus may answer there.
+    address = config[CONF_ADDRESS]
+    gated = CONF_ENABLE_PIN in config
+    if gated and address == DEFAULT_ADDRESS:
+        raise cv.Invalid(
+            f"an SI1145 with {CONF_ENABLE_PIN} is moved off 0x{DEFAULT_ADDRESS:02X} at boot, "
+            f"it needs another {CONF_ADDRESS}"
+        )
+    for conf in _i2c_devices(fv.full_config.get()):
+        if conf[CONF_I2C_ID] != config[CONF_I2C_ID] or conf[CONF_ID] == config[CONF_ID]:
+            continue
+        if conf.get(CONF_PLATFORM) != "si1145":
+            if conf[CONF_ADDRESS] == DEFAULT_ADDRESS:
+                raise cv.Invalid(
+                    f"SI1145 sensors power up at 0x{DEFAULT_ADDRESS:02X}, which "
+                    f"'{conf[CONF_ID]}' also uses on the same bus"
+                )
+            continue
+        if conf[CONF_ADDRESS] == address:
+            raise cv.Invalid(
+                f"{CONF_ADDRESS} 0x{address:02X} is also used by SI1145 '{conf[CONF_ID]}' "
+                "on the same bus"
+            )
+        if not gated and address == DEFAULT_ADDRESS and CONF_ENABLE_PIN in conf:
+            raise cv.Invalid(
+                f"SI1145 '{conf[CONF_ID]}' on the same bus powers up at 0x{DEFAULT_ADDRESS:02X} when "
+                f"its {CONF_ENABLE_PIN} goes high, this SI1145 needs another {CONF_ADDRESS}"
+            )
+        if not gated and CONF_ENABLE_PIN not in conf:
+            raise cv.Invalid(
+                f"SI1145 '{conf[CONF_ID]}' has no {CONF_ENABLE_PIN} either, only one SI1145 "
+                f"per bus can do without, the others need an {CONF_ENABLE_PIN}"
+            )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = final_validate_addresses
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
+    cg.add(var.set_trace_size(config[sample_trace.CONF_TRACE_SIZE]))
+
+    if CONF_ENABLE_PIN in config:
+        enable = await cg.gpio_pin_expression(config[CONF_ENABLE_PIN])
+        cg.add(var.set_enable_pin(enable))
 
     if CONF_VISIBLE in config:
         conf = config[CONF_VISIBLE]
@@ -127,3 +259,35 @@ async def to_code(config):
         conf = config[CONF_CALCULATED_LUX]
         sens = await sensor.new_sensor(conf)
         cg.add(var.set_illuminance_sensor(sens))
+
+    # poll at the fastest output rate, each output is published on its own schedule
+    intervals = {
+        key: config[key].get(CONF_UPDATE_INTERVAL, config[CONF_UPDATE_INTERVAL])
+        for key in OUTPUTS
+        if key in config
+    }
+    if intervals:
+        cg.add(var.set_update_interval(min(intervals.values())))
+    for key, interval in intervals.items():
+        cg.add(
+            var.set_output_schedule(OUTPUTS[key], interval, config[key][CONF_DELTA])
+        )
+
+    if CONF_FLICKER in config:
+        conf = config[CONF_FLICKER]
+        cg.add(var.set_flicker(conf[CONF_INTERVAL], conf[CONF_SAMPLES]))
+        if CONF_FLICKER_INDEX in conf:
+            sens = await sensor.new_sensor(conf[CONF_FLICKER_INDEX])
+            cg.add(var.set_flicker_index_sensor(sens))
+        if CONF_PERCENT_FLICKER in conf:
+            sens = await sensor.new_sensor(conf[CONF_PERCENT_FLICKER])
+            cg.add(var.set_percent_flicker_sensor(sens))
+        if CONF_FREQUENCY in conf:
+            sens = await sensor.new_sensor(conf[CONF_FREQUENCY])
+            cg.add(var.set_flicker_frequency_sensor(sens))
+
+    if bus_stats.CONF_BUS_STATS in config:
+        stats = await bus_stats.new_bus_stats(config[bus_stats.CONF_BUS_STATS])
+        cg.add(var.set_bus_stats(stats))
+
+    await bus_scheduler.register_bus_client(var, config)
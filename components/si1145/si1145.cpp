@@ -1,7 +1,9 @@
 #include <Arduino.h>
 #include "si1145.h"
 
+#include <algorithm>
 #include <cmath>
+#include <list>
 
 #include "esphome/core/log.h"
 
@@ -10,92 +12,61 @@ namespace si1145 {
 
 static const char *const TAG = "si1145.sensor";
 
-inline float visible_temp_correction(uint16_t value, uint8_t range, uint8_t gain, uint16_t temp,
-                                     uint16_t temp_at_begin) {
-  float vis = value;
-  if (range == Range::RANGE_LOW) {
-    switch (gain) {
-      case 0:
-        vis = vis - 0.3f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 1:
-        vis = vis - 0.11f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 2:
-        vis = vis - 0.06f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 3:
-        vis = vis - 0.03f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 4:
-        vis = vis - 0.01f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 5:
-        vis = vis - 0.008f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 6:
-        vis = vis - 0.007f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 7:
-        vis = vis - 0.008f * (temp - temp_at_begin) / 35.0f;
-        break;
-    }
-  }
-  return vis;
-}
+static const uint8_t SI1145_CHLIST = SI1145_PARAM_CHLIST_ENUV | SI1145_PARAM_CHLIST_ENALSIR |
+                                     SI1145_PARAM_CHLIST_ENALSVIS | SI1145_PARAM_CHLIST_ENPS1;
 
-inline float infrared_temp_correction(uint16_t value, uint8_t range, uint8_t gain, uint16_t temp,
-                                      uint16_t temp_at_begin) {
-  float ir = value;
-  if (range == Range::RANGE_LOW) {
-    switch (gain) {
-      case 0:
-        ir = ir - 0.3f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 1:
-        ir = ir - 0.06f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 2:
-        ir = ir - 0.03f * (temp - temp_at_begin) / 35.0f;
-        break;
-      case 3:
-        ir = ir - 0.01f * (temp - temp_at_begin) / 35.0f;
-        break;
-    }
-  }
-  return ir;
-}
+// Gated sensors are held off this long at boot, so those that kept power across an ESP reset
+// (and the address they were moved to) reset and all come back at the default address
+static const uint32_t SI1145_POWER_OFF_TIME = 30;
 
-inline float illumination_combine_sensors(float vis_value, uint8_t vis_range, uint8_t vis_gain, float ir_value,
-                                          uint8_t ir_range, uint8_t ir_gain) {
-  float range_vis = (vis_range == Range::RANGE_LOW) ? 1.0f : 14.5f;  // 14.5 if high range, 1 otherwise
-  float range_ir = (ir_range == Range::RANGE_LOW) ? 1.0f : 14.5f;    // 14.5 if high range, 1 otherwise
-  float lux = (5.41f * vis_value * range_vis) / (1 << vis_gain) + (-0.08f * ir_value * range_ir) / (1 << ir_gain);
-  if (lux < 0)
-    lux = 0;
-  return lux;
-}
+static std::list<SI1145Component *> si1145_sensors;  // NOLINT
+static bool enable_pin_setup_complete = false;       // NOLINT
 
-inline float apply_range_and_gain(float value, uint8_t range, uint8_t gain) {
-  float range_factor = (range == Range::RANGE_LOW) ? 1.0f : 14.5f;
-  return (value * range_factor) / (1 << gain);
-}
+SI1145Component::SI1145Component() { si1145_sensors.push_back(this); }
 
 void SI1145Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up Si1145...");
-  if (!this->begin_()) {
+  this->trace_.init(this->trace_size_);
+  this->target_address_ = this->address_;
+  this->enable_();
+  if (!this->locate_() || !this->begin_()) {
     this->mark_failed();
     return;
   }
-  this->set_visible_gain_(this->visible_gain_);
-  this->set_visible_range_(this->visible_range_);
-  this->set_infrared_gain_(this->infrared_gain_);
-  this->set_infrared_range_(this->infrared_range_);
+  if (this->warm_start_) {
+    // no need to wait a full update_interval for the first value
+    this->defer([this]() { this->update(); });
+  } else {
+    this->set_visible_gain_(this->visible_gain_);
+    this->set_visible_range_(this->visible_range_);
+    this->set_infrared_gain_(this->infrared_gain_);
+    this->set_infrared_range_(this->infrared_range_);
+  }
+
+  if (this->flicker_samples_ > 0) {
+    this->flicker_buffer_.resize(this->flicker_samples_);
+    this->flicker_times_.resize(this->flicker_samples_);
+    this->set_interval("flicker", this->flicker_interval_, [this]() { this->start_flicker_burst(); });
+  }
 }
 
 void SI1145Component::dump_config() {
   ESP_LOGCONFIG(TAG, "SI1145:");
   LOG_I2C_DEVICE(this);
+  LOG_PIN("  Enable Pin: ", this->enable_pin_);
+  if (this->warm_start_) {
+    ESP_LOGCONFIG(TAG, "  Warm start: configuration kept across restart");
+  }
+  if (this->bus_stats_ != nullptr) {
+    this->bus_stats_->log_stats(TAG);
+  }
+  if (this->flicker_samples_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Flicker: %u samples every %u ms", this->flicker_samples_, this->flicker_interval_);
+  }
+  if (this->trace_.is_enabled()) {
+    ESP_LOGCONFIG(TAG, "  Trace: %zu/%zu samples", this->trace_.size(), this->trace_size_);
+    this->dump_trace();
+  }
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with SI1145 failed!");
   }
@@ -104,68 +75,197 @@ void SI1145Component::dump_config() {
 float SI1145Component::get_setup_priority() const { return setup_priority::DATA; }
 
 void SI1145Component::update() {
+  if (this->flicker_active_)
+    return;
+  if (this->measure_phase_ == 0 && !this->schedule_outputs_())
+    return;
+#ifdef USE_BUS_SCHEDULER
+  if (this->bus_scheduler_ != nullptr) {
+    if (this->measure_phase_ != 0) {
+      // previous measurement still queued
+      return;
+    }
+    this->measure_phase_ = 1;
+    this->bus_scheduler_->submit(bus_scheduler::BUS_PRIORITY_SENSOR, [this]() -> uint32_t {
+      switch (this->measure_phase_++) {
+        case 1:
+          this->start_measurement_();
+          return 20;
+        case 2:
+          this->read_measurement_();
+          return 0;
+        default:
+          this->publish_measurement_();
+          this->measure_phase_ = 0;
+          if (this->flicker_pending_)
+            this->start_flicker_burst();
+          return bus_scheduler::BUS_JOB_DONE;
+      }
+    });
+    return;
+  }
+#endif
+  this->start_measurement_();
+  delay(20);
+  this->read_measurement_();
+  this->publish_measurement_();
+}
+
+bool SI1145Component::schedule_outputs_() {
+  sensor::Sensor *const sensors[SI1145_OUTPUT_COUNT] = {this->visible_sensor_, this->infrared_sensor_,
+                                                        this->uvindex_sensor_, this->illuminance_sensor_};
+  const uint32_t now = millis();
+  // half an update of slack so timer jitter doesn't skip a whole update
+  const uint32_t slack = this->get_update_interval() / 2;
+  this->due_ = 0;
+  for (uint8_t i = 0; i < SI1145_OUTPUT_COUNT; i++) {
+    if (sensors[i] == nullptr)
+      continue;
+    if (!std::isnan(this->output_published_[i]) && now - this->output_last_[i] + slack < this->output_interval_[i])
+      continue;
+    this->output_last_[i] = now;
+    this->due_ |= 1 << i;
+  }
+  return this->due_ != 0;
+}
+
+void SI1145Component::publish_(SI1145Output output, sensor::Sensor *sensor, float value) {
+  const float last = this->output_published_[output];
+  if (!std::isnan(last) && std::fabs(value - last) < this->output_delta_[output])
+    return;
+  this->output_published_[output] = value;
+  sensor->publish_state(value);
+}
+
+void SI1145Component::loop() {
+  if (!this->flicker_active_)
+    return;
+  const uint32_t now = micros();
+  if ((int32_t)(now - this->flicker_next_us_) < 0)
+    return;
+  // Burst samples are read here rather than through the bus scheduler: each one is a single 5 byte
+  // read (under 0.6ms @100kHz), no longer than a scheduled step, and queueing it would delay it by up
+  // to a loop, breaking the 1ms spacing. Actuator jobs still run between two samples.
+  if (this->flicker_count_ == 0)
+    this->flicker_start_us_ = now;
+  this->flicker_times_[this->flicker_count_] = now - this->flicker_start_us_;
+  this->flicker_buffer_[this->flicker_count_++] = read_visible_();
+  this->flicker_next_us_ += SI1145_FLICKER_PERIOD_US;
+  if ((int32_t)(now - this->flicker_next_us_) >= 0) {
+    // fell behind, don't read the missed samples back to back
+    this->flicker_next_us_ = now + SI1145_FLICKER_PERIOD_US;
+  }
+  if (this->flicker_count_ == this->flicker_buffer_.size())
+    this->finish_flicker_burst_();
+}
+
+void SI1145Component::start_flicker_burst() {
+  if (this->flicker_buffer_.empty() || this->flicker_active_)
+    return;
+  if (this->measure_phase_ != 0) {
+    // a scheduled measurement is between its steps, start once it's published
+    this->flicker_pending_ = true;
+    return;
+  }
+  this->flicker_pending_ = false;
+  // visible light only, at the fastest rate. Gain 0 integrates for 25.6us, each gain step doubles
+  // that, from gain 6 on a conversion would no longer fit the 1ms measurement period.
+  write_param_(SI1145_PARAM_CHLIST, SI1145_PARAM_CHLIST_ENALSVIS);
+  this->set_visible_gain_(0);
+  write8_(SI1145_REG_MEASRATE0, SI1145_FLICKER_MEASRATE & 0xFF);
+  write8_(SI1145_REG_MEASRATE1, SI1145_FLICKER_MEASRATE >> 8);
+  write8_(SI1145_REG_COMMAND, SI1145_PSALS_AUTO);
+  this->flicker_count_ = 0;
+  this->flicker_next_us_ = micros() + SI1145_FLICKER_PERIOD_US;
+  this->flicker_active_ = true;
+  this->high_freq_.start();
+}
+
+void SI1145Component::finish_flicker_burst_() {
+  this->flicker_active_ = false;
+  this->high_freq_.stop();
+  write_param_(SI1145_PARAM_CHLIST, SI1145_CHLIST);
+  // back to the gain auto range (or the configuration) chose
+  this->set_visible_gain_(this->visible_gain_);
+  write8_(SI1145_REG_MEASRATE0, 0xFF);
+  write8_(SI1145_REG_MEASRATE1, 0);
+  write8_(SI1145_REG_COMMAND, SI1145_PSALS_AUTO);
+
+  FlickerResult r = analyse_flicker(this->flicker_buffer_.data(), this->flicker_times_.data(), this->flicker_count_);
+  // the loop may not keep up with the nominal rate, a burst with a gap too long to resolve the
+  // flicker (or mains flicker, which a slow burst would alias) is not published
+  const uint32_t max_gap_us = flicker_max_gap(this->flicker_times_.data(), this->flicker_count_);
+  const bool valid = flicker_gap_resolves(max_gap_us, std::max(r.frequency, FLICKER_MIN_RESOLVED_FREQUENCY));
+  ESP_LOGD(TAG, "Flicker: index=%u/1000 percent=%u/10 frequency=%u/10Hz max gap=%uus", r.flicker_index,
+           r.percent_flicker, r.frequency, max_gap_us);
+  if (!valid)
+    ESP_LOGW(TAG, "Flicker burst discarded, %uus between two samples is too long", max_gap_us);
+  if (this->flicker_index_sensor_ != nullptr)
+    this->flicker_index_sensor_->publish_state(valid ? r.flicker_index / 1000.0f : NAN);
+  if (this->percent_flicker_sensor_ != nullptr)
+    this->percent_flicker_sensor_->publish_state(valid ? r.percent_flicker / 10.0f : NAN);
+  if (this->flicker_frequency_sensor_ != nullptr)
+    this->flicker_frequency_sensor_->publish_state(valid ? r.frequency / 10.0f : NAN);
+}
+
+void SI1145Component::start_measurement_() {
   // force measure
   write8_(SI1145_REG_COMMAND, SI1145_ALS_FORCE);
-  delay(20);
+}
+
+void SI1145Component::read_measurement_() {
+  const bool need_vis = this->is_due_(SI1145_OUTPUT_VISIBLE) || this->is_due_(SI1145_OUTPUT_ILLUMINANCE);
+  const bool need_ir = this->is_due_(SI1145_OUTPUT_INFRARED) || this->is_due_(SI1145_OUTPUT_ILLUMINANCE);
+  const bool need_tp = (need_vis && this->visible_temp_correction_) || (need_ir && this->infrared_temp_correction_);
 
-  float vis;
-  float ir;
-  float tp;
   uint8_t resp = read8_(SI1145_REG_RESPONSE);
   switch (resp) {
     case 0x80:  // Invalid command
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x88:  // PS1 overflow
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x89:  // PS2 overflow
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x8A:  // PS3 overflow
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x8C:  // VIS overflow
-      vis = OVERFLOW_VALUE;
-      ir = read_infrared_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x8D:  // IR overflow
-      ir = OVERFLOW_VALUE;
-      vis = read_visible_();
-      tp = read_temp_();
-      write8_(SI1145_REG_COMMAND, SI1145_NOP);
-      break;
     case 0x8E:  // AUX overflow
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = temp_at_begin_;
       write8_(SI1145_REG_COMMAND, SI1145_NOP);
       break;
     default:
-      vis = read_visible_();
-      ir = read_infrared_();
-      tp = read_temp_();
       break;
   }
 
+  this->als_overflow_ = resp == 0x8C || resp == 0x8D;
+  // only read back the channels the due outputs need
+  this->vis_read_ = need_vis || resp == 0x8C;
+  if (resp == 0x8C)
+    this->vis_ = OVERFLOW_VALUE;
+  else if (need_vis)
+    this->vis_ = read_visible_();
+  this->ir_read_ = need_ir || resp == 0x8D;
+  if (resp == 0x8D)
+    this->ir_ = OVERFLOW_VALUE;
+  else if (need_ir)
+    this->ir_ = read_infrared_();
+  if (resp == 0x8E)
+    this->tp_ = temp_at_begin_;
+  else if (need_tp)
+    this->tp_ = read_temp_();
+}
+
+void SI1145Component::publish_measurement_() {
+  float vis = this->vis_;
+  float ir = this->ir_;
+  float tp = this->tp_;
+
   // save raw values for auto range
   uint16_t visible_ar = vis;
   uint16_t infrared_ar = ir;
 
+  if (this->trace_.is_enabled() && this->vis_read_ && this->ir_read_) {
+    this->trace_.push(SI1145TraceSample{millis(), visible_ar, infrared_ar, static_cast<uint16_t>(tp),
+                                        static_cast<uint8_t>(visible_range_ | visible_gain_),
+                                        static_cast<uint8_t>(infrared_range_ | infrared_gain_)});
+  }
+
   // expected by IC
   uint8_t irq_status = read8_(SI1145_REG_IRQSTAT);
   write8_(SI1145_REG_IRQSTAT, irq_status);
@@ -180,34 +280,43 @@ void SI1145Component::update() {
   }
 
   // update sensors
-  if (this->visible_sensor_ != nullptr && vis != OVERFLOW_VALUE) {
-    this->visible_sensor_->publish_state(apply_range_and_gain(vis, visible_range_, visible_gain_));
+  if (this->is_due_(SI1145_OUTPUT_VISIBLE) && vis != OVERFLOW_VALUE) {
+    this->publish_(SI1145_OUTPUT_VISIBLE, this->visible_sensor_,
+                   apply_range_and_gain(vis, visible_range_, visible_gain_));
   }
 
-  if (this->infrared_sensor_ != nullptr && ir != OVERFLOW_VALUE) {
-    this->infrared_sensor_->publish_state(apply_range_and_gain(ir, infrared_range_, infrared_gain_));
+  if (this->is_due_(SI1145_OUTPUT_INFRARED) && ir != OVERFLOW_VALUE) {
+    this->publish_(SI1145_OUTPUT_INFRARED, this->infrared_sensor_,
+                   apply_range_and_gain(ir, infrared_range_, infrared_gain_));
   }
 
-  if (this->uvindex_sensor_ != nullptr && vis != OVERFLOW_VALUE && ir != OVERFLOW_VALUE) {
+  if (this->is_due_(SI1145_OUTPUT_UVINDEX) && !this->als_overflow_) {
     uint8_t uf = read_uvindex_();
-    this->uvindex_sensor_->publish_state(uf);
+    this->publish_(SI1145_OUTPUT_UVINDEX, this->uvindex_sensor_, uf);
   }
 
-  if (this->illuminance_sensor_ != nullptr && vis != OVERFLOW_VALUE && ir != OVERFLOW_VALUE) {
+  if (this->is_due_(SI1145_OUTPUT_ILLUMINANCE) && vis != OVERFLOW_VALUE && ir != OVERFLOW_VALUE) {
     float lux = illumination_combine_sensors(vis, visible_range_, visible_gain_, ir, infrared_range_, infrared_gain_);
-    this->illuminance_sensor_->publish_state(lux);
+    this->publish_(SI1145_OUTPUT_ILLUMINANCE, this->illuminance_sensor_, lux);
   }
 
-  // auto range
-  if (visible_mode_auto_) {
+  // auto range, on fresh readings only
+  if (visible_mode_auto_ && this->vis_read_) {
     this->auto_range_visible_(visible_ar);
   }
-  if (infrared_mode_auto_) {
+  if (infrared_mode_auto_ && this->ir_read_) {
     this->auto_range_infrared_(infrared_ar);
   }
   write8_(SI1145_REG_COMMAND, SI1145_NOP);
 }
 
+void SI1145Component::dump_trace() {
+  char info[96];
+  snprintf(info, sizeof(info), "temp_at_begin=%u vis_temp_correction=%d ir_temp_correction=%d", temp_at_begin_,
+           visible_temp_correction_, infrared_temp_correction_);
+  this->trace_.dump("si1145", info);
+}
+
 uint16_t SI1145Component::read_visible_() {
   uint16_t r = read16_(SI1145_REG_ALSVISDATA0);
   uint16_t vatzero = VALUE_AT_ZERO_HIGH;
@@ -250,55 +359,31 @@ bool SI1145Component::begin_() {
   if (id != 0x45)
     return false;  // look for SI1145
 
+  // the chip keeps its configuration across an ESP reboot or OTA if it stayed powered
+  if (this->address_ == this->target_address_ && this->apply_settings_(true)) {
+    ESP_LOGD(TAG, "Configuration kept across restart, skipping reset");
+    if (this->visible_mode_auto_) {
+      this->visible_gain_ = query_param_(SI1145_PARAM_ALSVISADCGAIN) & 0x07;
+      this->visible_range_ = (Range)(query_param_(SI1145_PARAM_ALSVISADCMISC) & Range::RANGE_HIGH);
+    }
+    if (this->infrared_mode_auto_) {
+      this->infrared_gain_ = query_param_(SI1145_PARAM_ALSIRADCGAIN) & 0x07;
+      this->infrared_range_ = (Range)(query_param_(SI1145_PARAM_ALSIRADCMISC) & Range::RANGE_HIGH);
+    }
+    this->warm_start_ = true;
+    temp_at_begin_ = read_temp_();
+    return true;
+  }
+
   this->reset_();
 
-  /***********************************/
-  // enable UVindex measurement coefficients!
-  write8_(SI1145_REG_UCOEFF0, 0x29);
-  write8_(SI1145_REG_UCOEFF1, 0x89);
-  write8_(SI1145_REG_UCOEFF2, 0x02);
-  write8_(SI1145_REG_UCOEFF3, 0x00);
-
-  // enable UV sensor
-  write_param_(SI1145_PARAM_CHLIST, SI1145_PARAM_CHLIST_ENUV | SI1145_PARAM_CHLIST_ENALSIR |
-                                        SI1145_PARAM_CHLIST_ENALSVIS | SI1145_PARAM_CHLIST_ENPS1);
-  // enable interrupt on every sample
-  write8_(SI1145_REG_INTCFG, SI1145_REG_INTCFG_INTOE);
-  write8_(SI1145_REG_IRQEN, SI1145_REG_IRQEN_ALSEVERYSAMPLE);
-
-  /****************************** Prox Sense 1 */
-
-  // program LED current
-  write8_(SI1145_REG_PSLED21, 0x03);  // 20mA for LED 1 only
-  write_param_(SI1145_PARAM_PS1ADCMUX, SI1145_PARAM_ADCMUX_LARGEIR);
-  // prox sensor #1 uses LED #1
-  write_param_(SI1145_PARAM_PSLED12SEL, SI1145_PARAM_PSLED12SEL_PS1LED1);
-  // fastest clocks, clock div 1
-  write_param_(SI1145_PARAM_PSADCGAIN, 0);
-  // take 511 clocks to measure
-  write_param_(SI1145_PARAM_PSADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK);
-  // in prox mode, high range
-  write_param_(SI1145_PARAM_PSADCMISC, SI1145_PARAM_PSADCMISC_RANGE | SI1145_PARAM_PSADCMISC_PSMODE);
-
-  write_param_(SI1145_PARAM_ALSIRADCMUX, SI1145_PARAM_ADCMUX_SMALLIR);
-  // fastest clocks, clock div 1
-  write_param_(SI1145_PARAM_ALSIRADCGAIN, infrared_gain_);
-  // take 511 clocks to measure
-  write_param_(SI1145_PARAM_ALSIRADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK);
-  // range mode
-  write_param_(SI1145_PARAM_ALSIRADCMISC, infrared_range_);
-
-  // fastest clocks, clock div 1
-  write_param_(SI1145_PARAM_ALSVISADCGAIN, visible_gain_);
-  // take 511 clocks to measure
-  write_param_(SI1145_PARAM_ALSVISADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK);
-  // range mode
-  write_param_(SI1145_PARAM_ALSVISADCMISC, visible_range_);
-
-  /************************/
-
-  // measurement rate for auto
-  write8_(SI1145_REG_MEASRATE0, 0xFF);  // 255 * 31.25uS = 8ms
+  // a reset may bring the chip back to the default address
+  if (!this->locate_())
+    return false;
+  if (this->address_ != this->target_address_ && !this->assign_address_())
+    return false;
+
+  this->apply_settings_(false);
 
   // auto run
   write8_(SI1145_REG_COMMAND, SI1145_PSALS_AUTO);
@@ -308,6 +393,67 @@ bool SI1145Component::begin_() {
   return true;
 }
 
+bool SI1145Component::apply_settings_(bool verify) {
+  struct Setting {
+    // parameter RAM or register
+    bool param;
+    uint8_t address;
+    uint8_t value;
+    // false for the range/gain auto range may have moved since they were written
+    bool check;
+  };
+  const Setting settings[] = {
+      // enable UVindex measurement coefficients!
+      {false, SI1145_REG_UCOEFF0, 0x29, true},
+      {false, SI1145_REG_UCOEFF1, 0x89, true},
+      {false, SI1145_REG_UCOEFF2, 0x02, true},
+      {false, SI1145_REG_UCOEFF3, 0x00, true},
+      // enable UV sensor
+      {true, SI1145_PARAM_CHLIST, SI1145_CHLIST, true},
+      // enable interrupt on every sample
+      {false, SI1145_REG_INTCFG, SI1145_REG_INTCFG_INTOE, true},
+      {false, SI1145_REG_IRQEN, SI1145_REG_IRQEN_ALSEVERYSAMPLE, true},
+      // program LED current, 20mA for LED 1 only
+      {false, SI1145_REG_PSLED21, 0x03, true},
+      {true, SI1145_PARAM_PS1ADCMUX, SI1145_PARAM_ADCMUX_LARGEIR, true},
+      // prox sensor #1 uses LED #1
+      {true, SI1145_PARAM_PSLED12SEL, SI1145_PARAM_PSLED12SEL_PS1LED1, true},
+      // fastest clocks, clock div 1
+      {true, SI1145_PARAM_PSADCGAIN, 0, true},
+      // take 511 clocks to measure
+      {true, SI1145_PARAM_PSADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK, true},
+      // in prox mode, high range
+      {true, SI1145_PARAM_PSADCMISC, SI1145_PARAM_PSADCMISC_RANGE | SI1145_PARAM_PSADCMISC_PSMODE, true},
+      {true, SI1145_PARAM_ALSIRADCMUX, SI1145_PARAM_ADCMUX_SMALLIR, true},
+      {true, SI1145_PARAM_ALSIRADCGAIN, infrared_gain_, !infrared_mode_auto_},
+      {true, SI1145_PARAM_ALSIRADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK, true},
+      {true, SI1145_PARAM_ALSIRADCMISC, infrared_range_, !infrared_mode_auto_},
+      {true, SI1145_PARAM_ALSVISADCGAIN, visible_gain_, !visible_mode_auto_},
+      {true, SI1145_PARAM_ALSVISADCOUNTER, SI1145_PARAM_ADCCOUNTER_511CLK, true},
+      {true, SI1145_PARAM_ALSVISADCMISC, visible_range_, !visible_mode_auto_},
+      // measurement rate for auto, 255 * 31.25uS = 8ms
+      {false, SI1145_REG_MEASRATE0, 0xFF, true},
+  };
+  for (const auto &setting : settings) {
+    if (!verify) {
+      if (setting.param)
+        write_param_(setting.address, setting.value);
+      else
+        write8_(setting.address, setting.value);
+      continue;
+    }
+    if (!setting.check)
+      continue;
+    uint8_t value = setting.param ? query_param_(setting.address) : read8_(setting.address);
+    if (value != setting.value) {
+      ESP_LOGD(TAG, "%s 0x%02X is 0x%02X instead of 0x%02X, reconfiguring", setting.param ? "Parameter" : "Register",
+               setting.address, value, setting.value);
+      return false;
+    }
+  }
+  return true;
+}
+
 void SI1145Component::reset_() {
   write8_(SI1145_REG_MEASRATE0, 0);
   write8_(SI1145_REG_MEASRATE1, 0);
@@ -324,6 +470,59 @@ void SI1145Component::reset_() {
   delay(10);
 }
 
+void SI1145Component::enable_() {
+  if (!enable_pin_setup_complete) {
+    bool gated = false;
+    for (auto &sensor : si1145_sensors) {
+      if (sensor->enable_pin_ != nullptr) {
+        sensor->enable_pin_->setup();
+        sensor->enable_pin_->digital_write(false);
+        gated = true;
+      }
+    }
+    if (gated) {
+      delay(SI1145_POWER_OFF_TIME);
+      // the sensor without an enable pin is powered and answers at the default address already,
+      // move it away before a gated sensor comes up there
+      for (auto &sensor : si1145_sensors) {
+        if (sensor->enable_pin_ != nullptr)
+          continue;
+        sensor->target_address_ = sensor->address_;
+        if (sensor->locate_() && sensor->address_ != sensor->target_address_)
+          sensor->assign_address_();
+      }
+    }
+    enable_pin_setup_complete = true;
+  }
+  if (this->enable_pin_ != nullptr) {
+    this->enable_pin_->digital_write(true);
+    // start-up time
+    delay(25);
+  }
+}
+
+bool SI1145Component::locate_() {
+  this->set_i2c_address(this->target_address_);
+  if (this->probe_())
+    return true;
+  if (this->target_address_ == SI1145_DEFAULT_ADDRESS)
+    return false;
+  this->set_i2c_address(SI1145_DEFAULT_ADDRESS);
+  return this->probe_();
+}
+
+bool SI1145Component::assign_address_() {
+  ESP_LOGD(TAG, "Moving SI1145 from 0x%02X to 0x%02X", this->address_, this->target_address_);
+  write_param_(SI1145_PARAM_I2CADDR, this->target_address_);
+  write8_(SI1145_REG_COMMAND, SI1145_BUSADDR);
+  this->set_i2c_address(this->target_address_);
+  if (!this->probe_()) {
+    ESP_LOGE(TAG, "SI1145 not found at 0x%02X after address change", this->target_address_);
+    return false;
+  }
+  return true;
+}
+
 void SI1145Component::set_visible_gain_(uint8_t gain) { write_param_(SI1145_PARAM_ALSVISADCGAIN, gain); }
 
 void SI1145Component::set_infrared_gain_(uint8_t gain) { write_param_(SI1145_PARAM_ALSIRADCGAIN, gain); }
@@ -333,80 +532,60 @@ void SI1145Component::set_visible_range_(uint8_t range) { write_param_(SI1145_PA
 void SI1145Component::set_infrared_range_(uint8_t range) { write_param_(SI1145_PARAM_ALSIRADCMISC, range); }
 
 void SI1145Component::auto_range_visible_(uint16_t read_value) {
-  if (read_value > 25000) {
-    if (visible_gain_ == 0) {
-      // at lowest gain, increase range
-      if (visible_range_ == Range::RANGE_LOW) {
-        visible_range_ = Range::RANGE_HIGH;
-        set_visible_range_(visible_range_);
-      }
-    } else if (visible_gain_ > 0) {
-      // reduce gain
-      visible_gain_ -= 1;
-      set_visible_gain_(visible_gain_);
-    }
-  } else if (read_value < 1500) {
-    if (visible_gain_ < 7) {
-      // increase gain
-      visible_gain_ += 1;
-      set_visible_gain_(visible_gain_);
-    } else if (visible_range_ == Range::RANGE_HIGH) {
-      // at highest gain, reduce range
-      visible_range_ = Range::RANGE_LOW;
-      visible_gain_ = 0;
-      set_visible_range_(visible_range_);
-      set_visible_gain_(visible_gain_);
-    }
-  }
+  uint8_t changed = auto_range_visible(read_value, this->visible_range_, this->visible_gain_);
+  if (changed & AUTO_RANGE_RANGE_CHANGED)
+    set_visible_range_(visible_range_);
+  if (changed & AUTO_RANGE_GAIN_CHANGED)
+    set_visible_gain_(visible_gain_);
 }
 
 void SI1145Component::auto_range_infrared_(uint16_t read_value) {
-  if (read_value > 65000 && infrared_range_ == Range::RANGE_HIGH) {
-    infrared_range_ = Range::RANGE_LOW;
-    infrared_gain_ = 0;
+  uint8_t changed = auto_range_infrared(read_value, this->infrared_range_, this->infrared_gain_);
+  if (changed & AUTO_RANGE_RANGE_CHANGED)
     set_infrared_range_(infrared_range_);
+  if (changed & AUTO_RANGE_GAIN_CHANGED)
     set_infrared_gain_(infrared_gain_);
-  } else if (read_value > 25000) {
-    if (infrared_gain_ == 0) {
-      if (infrared_range_ == Range::RANGE_LOW) {
-        // at lowest gain, increase range
-        infrared_range_ = Range::RANGE_HIGH;
-        set_infrared_range_(infrared_range_);
-      }
-    } else if (infrared_gain_ > 0) {
-      // reduce gain
-      infrared_gain_ -= 1;
-      set_infrared_gain_(infrared_gain_);
-    }
-  } else if (read_value < 1500) {
-    if (infrared_gain_ < 7) {
-      // increase gain
-      infrared_gain_ += 1;
-      set_infrared_gain_(infrared_gain_);
-    } else if (infrared_range_ == Range::RANGE_HIGH) {
-      // at highest gain, reduce range
-      infrared_range_ = Range::RANGE_LOW;
-      infrared_gain_ = 0;
-      set_infrared_range_(infrared_range_);
-      set_infrared_gain_(infrared_gain_);
-    }
-  }
 }
 
-void SI1145Component::write8_(uint8_t reg, uint8_t val) { this->write_byte(reg, val); }
+void SI1145Component::write8_(uint8_t reg, uint8_t val) {
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->write_byte(reg, val);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 3, ok);
+}
+
+bool SI1145Component::probe_() {
+  uint8_t id = 0;
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->read_byte(SI1145_REG_PARTID, &id);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 4, ok, 2);
+  return ok && id == 0x45;
+}
 
 uint8_t SI1145Component::read8_(uint8_t reg) {
   uint8_t d8 = 0;
-  this->read_byte(reg, &d8);
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->read_byte(reg, &d8);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 4, ok, 2);
   return d8;
 }
 
 uint16_t SI1145Component::read16_(uint8_t reg) {
   uint16_t d16 = 0;
-  this->read_byte_16(reg, &d16);
+  const uint32_t start = this->bus_stats_ != nullptr ? micros() : 0;
+  bool ok = this->read_byte_16(reg, &d16);
+  if (this->bus_stats_ != nullptr)
+    this->bus_stats_->record(start, 5, ok, 2);
   return (d16 >> 8) | ((d16 & 0xFF) << 8);
 }
 
+uint8_t SI1145Component::query_param_(uint8_t p) {
+  write8_(SI1145_REG_COMMAND, p | SI1145_PARAM_QUERY);
+  return read8_(SI1145_REG_PARAMRD);
+}
+
 uint8_t SI1145Component::write_param_(uint8_t p, uint8_t v) {
   write8_(SI1145_REG_PARAMWR, v);
   write8_(SI1145_REG_COMMAND, p | SI1145_PARAM_SET);
@@ -1,8 +1,20 @@
 #pragma once
 
+#include "esphome/components/bus_stats/bus_stats.h"
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/components/sample_trace/sample_trace.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "si1145_calc.h"
+
+#include <vector>
+
+#ifdef USE_BUS_SCHEDULER
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#endif
 
 namespace esphome {
 namespace si1145 {
@@ -89,8 +101,8 @@ static const uint8_t SI1145_REG_PS2DATA0 = 0x28;
 static const uint8_t SI1145_REG_PS2DATA1 = 0x29;
 static const uint8_t SI1145_REG_PARAMRD = 0x2E;
 static const uint8_t SI1145_REG_CHIPSTAT = 0x30;
-static const uint16_t VALUE_AT_ZERO_HIGH = 260;
-static const uint16_t VALUE_AT_ZERO_LOW = 270;
+
+static const uint8_t SI1145_DEFAULT_ADDRESS = 0x60;
 
 #define SI1145_REG_UVINDEX0 0x2C
 #define SI1145_REG_UVINDEX1 0x2D
@@ -102,13 +114,23 @@ static const uint16_t VALUE_AT_ZERO_LOW = 270;
 #define SI1145_PARAM_ALSIRADCGAIN 0x1E
 #define SI1145_PARAM_ALSIRADCMISC 0x1F
 
-#define OVERFLOW_VALUE 0x7FFF
+// Flicker burst: visible light only, MEASRATE 32 * 31.25us = 1ms between samples
+static const uint16_t SI1145_FLICKER_MEASRATE = 32;
+static const uint32_t SI1145_FLICKER_PERIOD_US = 1000;
 
-enum Range { RANGE_HIGH = 0x20, RANGE_LOW = 0x00 };
+enum SI1145Output : uint8_t {
+  SI1145_OUTPUT_VISIBLE = 0,
+  SI1145_OUTPUT_INFRARED,
+  SI1145_OUTPUT_UVINDEX,
+  SI1145_OUTPUT_ILLUMINANCE,
+  SI1145_OUTPUT_COUNT,
+};
 
 /// This class implements support for the SI1145 i2c sensor.
 class SI1145Component : public PollingComponent, public i2c::I2CDevice {
  public:
+  SI1145Component();
+
   void set_visible_sensor(sensor::Sensor *visible_sensor) { visible_sensor_ = visible_sensor; }
   void set_infrared_sensor(sensor::Sensor *infrared_sensor) { infrared_sensor_ = infrared_sensor; }
   void set_uvindex_sensor(sensor::Sensor *uvindex_sensor) { uvindex_sensor_ = uvindex_sensor; }
@@ -121,6 +143,24 @@ class SI1145Component : public PollingComponent, public i2c::I2CDevice {
   void set_infrared_range(Range v) { infrared_range_ = v; }
   void set_visible_gain(uint8_t v) { visible_gain_ = v; }
   void set_infrared_gain(uint8_t v) { infrared_gain_ = v; }
+  void set_bus_stats(bus_stats::BusStats *bus_stats) { bus_stats_ = bus_stats; }
+  void set_trace_size(size_t trace_size) { trace_size_ = trace_size; }
+  void set_enable_pin(GPIOPin *enable_pin) { enable_pin_ = enable_pin; }
+  void set_flicker(uint32_t interval, uint16_t samples) {
+    flicker_interval_ = interval;
+    flicker_samples_ = samples;
+  }
+  /// Publish an output every interval ms, and only when it changed by at least delta (0: always).
+  void set_output_schedule(SI1145Output output, uint32_t interval, float delta) {
+    output_interval_[output] = interval;
+    output_delta_[output] = delta;
+  }
+  void set_flicker_index_sensor(sensor::Sensor *s) { flicker_index_sensor_ = s; }
+  void set_percent_flicker_sensor(sensor::Sensor *s) { percent_flicker_sensor_ = s; }
+  void set_flicker_frequency_sensor(sensor::Sensor *s) { flicker_frequency_sensor_ = s; }
+#ifdef USE_BUS_SCHEDULER
+  void set_bus_scheduler(bus_scheduler::BusScheduler *bus_scheduler) { bus_scheduler_ = bus_scheduler; }
+#endif
 
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
@@ -128,6 +168,13 @@ class SI1145Component : public PollingComponent, public i2c::I2CDevice {
   void dump_config() override;
   float get_setup_priority() const override;
   void update() override;
+  void loop() override;
+  /// Log the captured raw samples for tools/trace_replay.cpp
+  void dump_trace();
+  /// Sample visible light at 1kHz for flicker_samples_ ms, then publish the flicker sensors.
+  /// The burst is read from loop(), a sample at a time, so it doesn't block. During a queued
+  /// measurement the burst starts once the measurement is published.
+  void start_flicker_burst();
 
  protected:
   // Read visible light
@@ -138,15 +185,37 @@ class SI1145Component : public PollingComponent, public i2c::I2CDevice {
   uint8_t read_uvindex_();
   // Read temp
   uint16_t read_temp_();
+  // Measurement steps: force a conversion, read it back 20ms later, publish
+  void start_measurement_();
+  void read_measurement_();
+  void publish_measurement_();
+  // Pick the outputs due on this update, returns false if there is nothing to do
+  bool schedule_outputs_();
+  bool is_due_(SI1145Output output) const { return (this->due_ & (1 << output)) != 0; }
+  void publish_(SI1145Output output, sensor::Sensor *sensor, float value);
+  // End of a flicker burst: restore the normal configuration, analyse and publish
+  void finish_flicker_burst_();
   // Begin
   bool begin_();
   // Reset
   void reset_();
+  // Power up this sensor, keeping every other gated sensor off until its turn. The first call also
+  // moves the sensor without an enable pin off the default address.
+  void enable_();
+  // Find the sensor at its configured or at the default address
+  bool locate_();
+  // Move the sensor from the default to the configured address
+  bool assign_address_();
+  // Whether an SI1145 answers at the current address
+  bool probe_();
   // Aux RW fns
   void write8_(uint8_t reg, uint8_t val);
   uint8_t read8_(uint8_t reg);
   uint16_t read16_(uint8_t reg);
   uint8_t write_param_(uint8_t p, uint8_t v);
+  uint8_t query_param_(uint8_t p);
+  // Write the configuration, or with verify compare it with the chip's and return false on a mismatch
+  bool apply_settings_(bool verify);
 
   void auto_range_visible_(uint16_t read_value);
   void auto_range_infrared_(uint16_t read_value);
@@ -160,10 +229,17 @@ class SI1145Component : public PollingComponent, public i2c::I2CDevice {
   void set_infrared_range_(uint8_t range);
 
   // Sensors
-  sensor::Sensor *visible_sensor_;
-  sensor::Sensor *infrared_sensor_;
-  sensor::Sensor *uvindex_sensor_;
-  sensor::Sensor *illuminance_sensor_;
+  sensor::Sensor *visible_sensor_{nullptr};
+  sensor::Sensor *infrared_sensor_{nullptr};
+  sensor::Sensor *uvindex_sensor_{nullptr};
+  sensor::Sensor *illuminance_sensor_{nullptr};
+  sensor::Sensor *flicker_index_sensor_{nullptr};
+  sensor::Sensor *percent_flicker_sensor_{nullptr};
+  sensor::Sensor *flicker_frequency_sensor_{nullptr};
+  bus_stats::BusStats *bus_stats_{nullptr};
+#ifdef USE_BUS_SCHEDULER
+  bus_scheduler::BusScheduler *bus_scheduler_{nullptr};
+#endif
 
   // Settings
   Range visible_range_ = Range::RANGE_LOW;
@@ -178,6 +254,45 @@ class SI1145Component : public PollingComponent, public i2c::I2CDevice {
   bool infrared_temp_correction_ = false;
 
   uint16_t temp_at_begin_ = 0;
+  // setup found the chip already configured
+  bool warm_start_ = false;
+
+  GPIOPin *enable_pin_{nullptr};
+  uint8_t target_address_ = SI1145_DEFAULT_ADDRESS;
+
+  // Per output schedule and publish-on-change threshold
+  uint32_t output_interval_[SI1145_OUTPUT_COUNT] = {0};
+  float output_delta_[SI1145_OUTPUT_COUNT] = {0};
+  uint32_t output_last_[SI1145_OUTPUT_COUNT] = {0};
+  float output_published_[SI1145_OUTPUT_COUNT] = {NAN, NAN, NAN, NAN};
+  // outputs due on the current measurement
+  uint8_t due_ = 0;
+
+  // Last raw sample, between read_measurement_() and publish_measurement_()
+  float vis_ = 0;
+  float ir_ = 0;
+  float tp_ = 0;
+  // channels read by the last read_measurement_()
+  bool vis_read_ = false;
+  bool ir_read_ = false;
+  bool als_overflow_ = false;
+  uint8_t measure_phase_ = 0;
+
+  size_t trace_size_ = 0;
+  sample_trace::SampleTrace<SI1145TraceSample> trace_;
+
+  // Flicker burst, the buffer is sized once in setup()
+  uint32_t flicker_interval_ = 0;
+  uint16_t flicker_samples_ = 0;
+  std::vector<uint16_t> flicker_buffer_;
+  // read time of each sample, relative to the first one
+  std::vector<uint32_t> flicker_times_;
+  size_t flicker_count_ = 0;
+  bool flicker_active_ = false;
+  bool flicker_pending_ = false;
+  uint32_t flicker_start_us_ = 0;
+  uint32_t flicker_next_us_ = 0;
+  HighFrequencyLoopRequester high_freq_;
 
   enum ErrorCode {
     NONE = 0,
@@ -0,0 +1,264 @@
+#pragma once
+
+// Conversion and auto range math of the SI1145, free of ESPHome dependencies so it can be
+// reused by the host trace replay tool (tools/trace_replay.cpp).
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace si1145 {
+
+static const uint16_t VALUE_AT_ZERO_HIGH = 260;
+static const uint16_t VALUE_AT_ZERO_LOW = 270;
+
+#define OVERFLOW_VALUE 0x7FFF
+
+enum Range { RANGE_HIGH = 0x20, RANGE_LOW = 0x00 };
+
+// Auto range thresholds (raw counts)
+static const uint16_t AUTO_RANGE_HIGH = 25000;
+static const uint16_t AUTO_RANGE_LOW = 1500;
+static const uint16_t AUTO_RANGE_SATURATED = 65000;
+// Auto range result flags
+static const uint8_t AUTO_RANGE_RANGE_CHANGED = 0x01;
+static const uint8_t AUTO_RANGE_GAIN_CHANGED = 0x02;
+
+/// Raw sample captured by the trace mode, little endian as stored on the device.
+struct SI1145TraceSample {
+  uint32_t timestamp;
+  uint16_t visible;
+  uint16_t infrared;
+  uint16_t temp;
+  // range | gain
+  uint8_t visible_config;
+  uint8_t infrared_config;
+} __attribute__((packed));
+
+inline float visible_temp_correction(uint16_t value, uint8_t range, uint8_t gain, uint16_t temp,
+                                     uint16_t temp_at_begin) {
+  float vis = value;
+  if (range == Range::RANGE_LOW) {
+    switch (gain) {
+      case 0:
+        vis = vis - 0.3f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 1:
+        vis = vis - 0.11f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 2:
+        vis = vis - 0.06f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 3:
+        vis = vis - 0.03f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 4:
+        vis = vis - 0.01f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 5:
+        vis = vis - 0.008f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 6:
+        vis = vis - 0.007f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 7:
+        vis = vis - 0.008f * (temp - temp_at_begin) / 35.0f;
+        break;
+    }
+  }
+  return vis;
+}
+
+inline float infrared_temp_correction(uint16_t value, uint8_t range, uint8_t gain, uint16_t temp,
+                                      uint16_t temp_at_begin) {
+  float ir = value;
+  if (range == Range::RANGE_LOW) {
+    switch (gain) {
+      case 0:
+        ir = ir - 0.3f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 1:
+        ir = ir - 0.06f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 2:
+        ir = ir - 0.03f * (temp - temp_at_begin) / 35.0f;
+        break;
+      case 3:
+        ir = ir - 0.01f * (temp - temp_at_begin) / 35.0f;
+        break;
+    }
+  }
+  return ir;
+}
+
+inline float illumination_combine_sensors(float vis_value, uint8_t vis_range, uint8_t vis_gain, float ir_value,
+                                          uint8_t ir_range, uint8_t ir_gain) {
+  float range_vis = (vis_range == Range::RANGE_LOW) ? 1.0f : 14.5f;  // 14.5 if high range, 1 otherwise
+  float range_ir = (ir_range == Range::RANGE_LOW) ? 1.0f : 14.5f;    // 14.5 if high range, 1 otherwise
+  float lux = (5.41f * vis_value * range_vis) / (1 << vis_gain) + (-0.08f * ir_value * range_ir) / (1 << ir_gain);
+  if (lux < 0)
+    lux = 0;
+  return lux;
+}
+
+inline float apply_range_and_gain(float value, uint8_t range, uint8_t gain) {
+  float range_factor = (range == Range::RANGE_LOW) ? 1.0f : 14.5f;
+  return (value * range_factor) / (1 << gain);
+}
+
+/// Pick the next visible range/gain from a raw reading, returns AUTO_RANGE_* flags.
+inline uint8_t auto_range_visible(uint16_t read_value, Range &range, uint8_t &gain, uint16_t high = AUTO_RANGE_HIGH,
+                                  uint16_t low = AUTO_RANGE_LOW) {
+  uint8_t changed = 0;
+  if (read_value > high) {
+    if (gain == 0) {
+      // at lowest gain, increase range
+      if (range == Range::RANGE_LOW) {
+        range = Range::RANGE_HIGH;
+        changed |= AUTO_RANGE_RANGE_CHANGED;
+      }
+    } else if (gain > 0) {
+      // reduce gain
+      gain -= 1;
+      changed |= AUTO_RANGE_GAIN_CHANGED;
+    }
+  } else if (read_value < low) {
+    if (gain < 7) {
+      // increase gain
+      gain += 1;
+      changed |= AUTO_RANGE_GAIN_CHANGED;
+    } else if (range == Range::RANGE_HIGH) {
+      // at highest gain, reduce range
+      range = Range::RANGE_LOW;
+      gain = 0;
+      changed |= AUTO_RANGE_RANGE_CHANGED | AUTO_RANGE_GAIN_CHANGED;
+    }
+  }
+  return changed;
+}
+
+/// Pick the next infrared range/gain from a raw reading, returns AUTO_RANGE_* flags.
+inline uint8_t auto_range_infrared(uint16_t read_value, Range &range, uint8_t &gain, uint16_t high = AUTO_RANGE_HIGH,
+                                   uint16_t low = AUTO_RANGE_LOW, uint16_t saturated = AUTO_RANGE_SATURATED) {
+  uint8_t changed = 0;
+  if (read_value > saturated && range == Range::RANGE_HIGH) {
+    range = Range::RANGE_LOW;
+    gain = 0;
+    changed |= AUTO_RANGE_RANGE_CHANGED | AUTO_RANGE_GAIN_CHANGED;
+  } else if (read_value > high) {
+    if (gain == 0) {
+      if (range == Range::RANGE_LOW) {
+        // at lowest gain, increase range
+        range = Range::RANGE_HIGH;
+        changed |= AUTO_RANGE_RANGE_CHANGED;
+      }
+    } else if (gain > 0) {
+      // reduce gain
+      gain -= 1;
+      changed |= AUTO_RANGE_GAIN_CHANGED;
+    }
+  } else if (read_value < low) {
+    if (gain < 7) {
+      // increase gain
+      gain += 1;
+      changed |= AUTO_RANGE_GAIN_CHANGED;
+    } else if (range == Range::RANGE_HIGH) {
+      // at highest gain, reduce range
+      range = Range::RANGE_LOW;
+      gain = 0;
+      changed |= AUTO_RANGE_RANGE_CHANGED | AUTO_RANGE_GAIN_CHANGED;
+    }
+  }
+  return changed;
+}
+
+/// Flicker metrics of a burst of visible light samples, in fixed point.
+struct FlickerResult {
+  // area above the mean over the total area, x1000
+  uint16_t flicker_index;
+  // 100 * (max - min) / (max + min), x10
+  uint16_t percent_flicker;
+  // dominant frequency from the mean crossings, x10 Hz, 0 if no periodic signal was found
+  uint16_t frequency;
+};
+
+/// Percent flicker (x10) below which a burst is taken as a steady light: ADC noise alone reaches
+/// a few tenths of a percent at gain 0.
+static const uint16_t FLICKER_MIN_PERCENT = 10;
+/// Smallest hysteresis (counts) around the mean for a crossing. (hi - lo) / 8 alone shrinks with
+/// the signal, and on a dim light every noise swing would count as a crossing.
+static const uint32_t FLICKER_MIN_HYSTERESIS = 4;
+
+/// times_us holds the time each sample was read, relative to the first one.
+inline FlickerResult analyse_flicker(const uint16_t *samples, const uint32_t *times_us, size_t count) {
+  FlickerResult result{0, 0, 0};
+  if (count < 2)
+    return result;
+
+  uint32_t lo = UINT16_MAX;
+  uint32_t hi = 0;
+  uint32_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    lo = samples[i] < lo ? samples[i] : lo;
+    hi = samples[i] > hi ? samples[i] : hi;
+    sum += samples[i];
+  }
+  if (sum == 0)
+    return result;
+  const uint32_t mean = sum / count;
+
+  uint32_t above = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (samples[i] > mean)
+      above += samples[i] - mean;
+  }
+  const uint16_t percent_flicker = static_cast<uint16_t>((hi - lo) * 1000 / (hi + lo));
+  if (percent_flicker < FLICKER_MIN_PERCENT)
+    return result;
+  result.flicker_index = static_cast<uint16_t>((uint64_t) above * 1000 / sum);
+  result.percent_flicker = percent_flicker;
+
+  // rising mean crossings, with hysteresis so noise doesn't count
+  const uint32_t hysteresis = (hi - lo) / 8 > FLICKER_MIN_HYSTERESIS ? (hi - lo) / 8 : FLICKER_MIN_HYSTERESIS;
+  bool below = samples[0] < mean;
+  size_t first = 0;
+  size_t last = 0;
+  size_t crossings = 0;
+  for (size_t i = 1; i < count; i++) {
+    if (below && samples[i] > mean + hysteresis) {
+      below = false;
+      if (crossings == 0)
+        first = i;
+      last = i;
+      crossings++;
+    } else if (!below && samples[i] + hysteresis < mean) {
+      below = true;
+    }
+  }
+  if (crossings >= 2 && times_us[last] > times_us[first]) {
+    result.frequency =
+        static_cast<uint16_t>((uint64_t)(crossings - 1) * 10000000ULL / (times_us[last] - times_us[first]));
+  }
+  return result;
+}
+
+/// Longest time between two consecutive samples of a burst, in us.
+inline uint32_t flicker_max_gap(const uint32_t *times_us, size_t count) {
+  uint32_t gap = 0;
+  for (size_t i = 1; i < count; i++)
+    gap = times_us[i] - times_us[i - 1] > gap ? times_us[i] - times_us[i - 1] : gap;
+  return gap;
+}
+
+/// Lowest frequency (x10 Hz) a burst must resolve: the 120Hz flicker of 60Hz mains. A slower
+/// sampled burst would alias it to a lower frequency, so a lower detected frequency proves nothing.
+static const uint16_t FLICKER_MIN_RESOLVED_FREQUENCY = 1200;
+
+/// Nyquist: a burst resolves a frequency (x10 Hz) if no gap between samples reaches half its period.
+inline bool flicker_gap_resolves(uint32_t max_gap_us, uint16_t frequency) {
+  return (uint64_t) max_gap_us * 2 * frequency < 10000000ULL;
+}
+
+}  // namespace si1145
+}  // namespace esphome
@@ -6,6 +6,8 @@ from esphome.const import CONF_ID, CONF_DELAY
 DEPENDENCIES = ["uart"]
 MULTI_CONF = True
 CONF_INIT_DATA = "init_data"
+CONF_TX_BUFFER_SIZE = "tx_buffer_size"
+CONF_TX_FIFO_SIZE = "tx_fifo_size"
 
 uartpin_ns = cg.esphome_ns.namespace("uartpin")
 UARTPINComponent = uartpin_ns.class_("UARTPINComponent", cg.Component, uart.UARTDevice)
@@ -27,6 +29,8 @@ CONFIG_SCHEMA = (
             cv.GenerateID(): cv.declare_id(UARTPINComponent),
             cv.Optional(CONF_DELAY): cv.update_interval,
             cv.Optional(CONF_INIT_DATA): validate_raw_data,
+            cv.Optional(CONF_TX_BUFFER_SIZE, default=256): cv.int_range(min=16, max=4096),
+            cv.Optional(CONF_TX_FIFO_SIZE, default=128): cv.int_range(min=1, max=1024),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -38,6 +42,8 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     if CONF_DELAY in config:
         cg.add(var.set_init_delay(config[CONF_DELAY]))
+    cg.add(var.set_tx_buffer_size(config[CONF_TX_BUFFER_SIZE]))
+    cg.add(var.set_tx_fifo_size(config[CONF_TX_FIFO_SIZE]))
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
     if CONF_INIT_DATA in config:
@@ -1,15 +1,30 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import output
-from esphome.const import CONF_CHANNEL, CONF_ID
+from esphome.const import CONF_CHANNEL, CONF_ID, CONF_MIN_VALUE, CONF_MAX_VALUE
+from esphome.core import HexInt
 from . import UARTPINComponent, uartpin_ns
 
 DEPENDENCIES = ["uartpin"]
 
-UARTPINChannel = uartpin_ns.class_("UARTPINChannel", output.FloatOutput)
+UARTPINChannel = uartpin_ns.class_("UARTPINChannel", output.BinaryOutput)
+UARTPINFloatChannel = uartpin_ns.class_("UARTPINFloatChannel", output.FloatOutput)
 CONF_UARTPIN_ID = "uartpin_id"
 CONF_DATA_HIGH = "data_high"
 CONF_DATA_LOW = "data_low"
+CONF_DATA_TEMPLATE = "data_template"
+CONF_LEVEL_OFFSET = "level_offset"
+CONF_LEVEL_SIZE = "level_size"
+CONF_CHECKSUM = "checksum"
+CONF_CHECKSUM_OFFSET = "checksum_offset"
+CONF_MIN_INTERVAL = "min_interval"
+
+UARTPINChecksum = uartpin_ns.enum("UARTPINChecksum")
+CHECKSUM_OPTIONS = {
+    "none": UARTPINChecksum.UARTPIN_CHECKSUM_NONE,
+    "sum": UARTPINChecksum.UARTPIN_CHECKSUM_SUM,
+    "xor": UARTPINChecksum.UARTPIN_CHECKSUM_XOR,
+}
 
 def validate_raw_data(value):
     if isinstance(value, str):
@@ -22,7 +37,29 @@ def validate_raw_data(value):
         "data must either be a string wrapped in quotes or a list of bytes"
     )
 
-CONFIG_SCHEMA = output.BINARY_OUTPUT_SCHEMA.extend(
+def validate_frame(config):
+    size = len(config[CONF_DATA_TEMPLATE])
+    if config[CONF_LEVEL_OFFSET] + config[CONF_LEVEL_SIZE] > size:
+        raise cv.Invalid("level bytes don't fit in data_template")
+    if config[CONF_MIN_VALUE] >= config[CONF_MAX_VALUE]:
+        raise cv.Invalid("min_value must be lower than max_value")
+    if config[CONF_LEVEL_SIZE] == 1 and config[CONF_MAX_VALUE] > 255:
+        raise cv.Invalid("max_value doesn't fit in a single level byte")
+    if CONF_CHECKSUM_OFFSET not in config:
+        config[CONF_CHECKSUM_OFFSET] = size - 1
+    if config[CONF_CHECKSUM_OFFSET] >= size:
+        raise cv.Invalid("checksum_offset is outside data_template")
+    level_start = config[CONF_LEVEL_OFFSET]
+    level_end = level_start + config[CONF_LEVEL_SIZE]
+    if (
+        config[CONF_CHECKSUM] != "none"
+        and level_start <= config[CONF_CHECKSUM_OFFSET] < level_end
+    ):
+        raise cv.Invalid("checksum_offset overlaps the level bytes")
+    return config
+
+
+BINARY_SCHEMA = output.BINARY_OUTPUT_SCHEMA.extend(
     {
         cv.Required(CONF_ID): cv.declare_id(UARTPINChannel),
         cv.GenerateID(CONF_UARTPIN_ID): cv.use_id(UARTPINComponent),
@@ -31,9 +68,56 @@ CONFIG_SCHEMA = output.BINARY_OUTPUT_SCHEMA.extend(
     }
 )
 
+FLOAT_SCHEMA = cv.All(
+    output.FLOAT_OUTPUT_SCHEMA.extend(
+        {
+            cv.Required(CONF_ID): cv.declare_id(UARTPINFloatChannel),
+            cv.GenerateID(CONF_UARTPIN_ID): cv.use_id(UARTPINComponent),
+            cv.Required(CONF_DATA_TEMPLATE): validate_raw_data,
+            cv.Required(CONF_LEVEL_OFFSET): cv.uint8_t,
+            cv.Optional(CONF_LEVEL_SIZE, default=1): cv.int_range(min=1, max=2),
+            cv.Optional(CONF_MIN_VALUE, default=0): cv.uint16_t,
+            cv.Optional(CONF_MAX_VALUE, default=255): cv.uint16_t,
+            cv.Optional(CONF_CHECKSUM, default="none"): cv.enum(
+                CHECKSUM_OPTIONS, lower=True
+            ),
+            cv.Optional(CONF_CHECKSUM_OFFSET): cv.uint8_t,
+            cv.Optional(
+                CONF_MIN_INTERVAL, default="100ms"
+            ): cv.positive_time_period_milliseconds,
+        }
+    ),
+    validate_frame,
+)
+
+
+def validate_channel(value):
+    # a frame template selects the multi-level channel
+    if isinstance(value, dict) and CONF_DATA_TEMPLATE in value:
+        return FLOAT_SCHEMA(value)
+    return BINARY_SCHEMA(value)
+
+
+CONFIG_SCHEMA = validate_channel
+
 
 async def to_code(config):
     paren = await cg.get_variable(config[CONF_UARTPIN_ID])
+    if CONF_DATA_TEMPLATE in config:
+        data = config[CONF_DATA_TEMPLATE]
+        if isinstance(data, bytes):
+            data = [HexInt(x) for x in data]
+        rhs = paren.create_float_channel()
+        var = cg.Pvariable(config[CONF_ID], rhs)
+        cg.add(var.set_data_template(data))
+        cg.add(var.set_level_offset(config[CONF_LEVEL_OFFSET]))
+        cg.add(var.set_level_size(config[CONF_LEVEL_SIZE]))
+        cg.add(var.set_level_range(config[CONF_MIN_VALUE], config[CONF_MAX_VALUE]))
+        cg.add(var.set_checksum(config[CONF_CHECKSUM], config[CONF_CHECKSUM_OFFSET]))
+        cg.add(var.set_min_interval(config[CONF_MIN_INTERVAL]))
+        await output.register_output(var, config)
+        return
+
     datah = config[CONF_DATA_HIGH]
     if isinstance(datah, bytes):
         datah = [HexInt(x) for x in datah]
@@ -1,5 +1,7 @@
 #include "uartpin.h"
 
+#include <algorithm>
+
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
@@ -10,10 +12,15 @@ static const char *const TAG = "uartpin";
 
 void UARTPINComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up UARTPINComponent...");
+  this->tx_buffer_.resize(this->tx_buffer_size_);
 }
 
 void UARTPINComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "UARTPIN:");
+  ESP_LOGCONFIG(TAG, "  TX buffer: %zu bytes (FIFO chunk %zu bytes)", this->tx_buffer_size_, this->tx_fifo_size_);
+  ESP_LOGCONFIG(TAG, "  TX queued: %zu bytes (max %zu bytes), overflows: %u", this->tx_count_, this->tx_count_max_,
+                this->tx_overflows_);
+  ESP_LOGCONFIG(TAG, "  TX max blocking time: %u us", this->tx_max_blocking_us_);
   if (this->is_failed()) {
     ESP_LOGE(TAG, "Communication with UARTPIN failed!");
   }
@@ -26,15 +33,96 @@ void UARTPINComponent::loop() {
       this->write_to_uart(this->init_data_);
     }
   }
+  for (auto *channel : this->float_channels_) {
+    channel->flush_();
+  }
+  this->service_tx_();
 }
 
 UARTPINChannel *UARTPINComponent::create_channel() {
   return new UARTPINChannel(this);
 }
 
+UARTPINFloatChannel *UARTPINComponent::create_float_channel() {
+  auto *c = new UARTPINFloatChannel(this);
+  this->float_channels_.push_back(c);
+  return c;
+}
+
 void UARTPINComponent::write_to_uart(const std::vector<uint8_t> &data) {
-  if (this->init_) {
+  this->write_to_uart(data, nullptr);
+}
+
+void UARTPINComponent::write_to_uart(const std::vector<uint8_t> &data, std::function<void()> &&on_sent) {
+  if (!this->init_ || data.empty()) {
+    return;
+  }
+  const size_t size = this->tx_buffer_.size();
+  if (data.size() > size - this->tx_count_) {
+    // no room left, this is the only path that blocks the main loop
+    this->tx_overflows_++;
+    ESP_LOGW(TAG, "TX buffer full, flushing %zu bytes", this->tx_count_);
+    this->drain_tx_(this->tx_count_);
+  }
+  if (data.size() > size) {
+    const uint32_t start = micros();
     this->write_array(&data[0], data.size());
+    this->tx_last_us_ = micros();
+    this->tx_max_blocking_us_ = std::max(this->tx_max_blocking_us_, this->tx_last_us_ - start);
+    if (on_sent)
+      on_sent();
+    return;
+  }
+
+  for (uint8_t b : data) {
+    this->tx_buffer_[this->tx_head_] = b;
+    this->tx_head_ = (this->tx_head_ + 1) % size;
+  }
+  this->tx_count_ += data.size();
+  this->tx_queued_total_ += data.size();
+  this->tx_count_max_ = std::max(this->tx_count_max_, this->tx_count_);
+  if (on_sent)
+    this->tx_callbacks_.emplace_back(this->tx_queued_total_, std::move(on_sent));
+  this->high_freq_.start();
+  this->service_tx_();
+}
+
+void UARTPINComponent::service_tx_() {
+  if (this->tx_count_ == 0) {
+    this->high_freq_.stop();
+    return;
+  }
+  // bytes shifted out since the last call (10 bits per byte on the line)
+  const uint32_t now = micros();
+  const uint64_t elapsed = now - this->tx_last_us_;
+  const uint64_t budget = elapsed * this->parent_->get_baud_rate() / 10000000ULL;
+  if (budget == 0)
+    return;
+  this->drain_tx_(std::min<uint64_t>(budget, this->tx_fifo_size_));
+}
+
+void UARTPINComponent::drain_tx_(size_t max_bytes) {
+  size_t n = std::min(max_bytes, this->tx_count_);
+  if (n == 0)
+    return;
+  const uint32_t start = micros();
+  while (n > 0) {
+    const size_t chunk = std::min(n, this->tx_buffer_.size() - this->tx_tail_);
+    this->write_array(&this->tx_buffer_[this->tx_tail_], chunk);
+    this->tx_tail_ = (this->tx_tail_ + chunk) % this->tx_buffer_.size();
+    this->tx_count_ -= chunk;
+    this->tx_sent_total_ += chunk;
+    n -= chunk;
+  }
+  // the line budget of service_tx_() counts from the last write, whichever path made it
+  this->tx_last_us_ = micros();
+  this->tx_max_blocking_us_ = std::max(this->tx_max_blocking_us_, this->tx_last_us_ - start);
+
+  while (!this->tx_callbacks_.empty() &&
+         static_cast<int32_t>(this->tx_sent_total_ - this->tx_callbacks_.front().first) >= 0) {
+    auto on_sent = std::move(this->tx_callbacks_.front().second);
+    this->tx_callbacks_.erase(this->tx_callbacks_.begin());
+    on_sent();
   }
 }
 
@@ -64,5 +152,63 @@ void UARTPINChannel::set_data_low(const std::vector<uint8_t> &data) {
   this->data_low_ = data;
 }
 
+void UARTPINFloatChannel::set_data_template(const std::vector<uint8_t> &data) {
+  this->frame_ = data;
+}
+
+void UARTPINFloatChannel::set_level_range(uint16_t min_level, uint16_t max_level) {
+  this->min_level_ = min_level;
+  this->max_level_ = max_level;
+}
+
+void UARTPINFloatChannel::set_checksum(UARTPINChecksum checksum, uint8_t offset) {
+  this->checksum_ = checksum;
+  this->checksum_offset_ = offset;
+}
+
+void UARTPINFloatChannel::write_state(float state) {
+  const float span = this->max_level_ - this->min_level_;
+  auto level = static_cast<uint16_t>(this->min_level_ + roundf(state * span));
+  if (this->sent_ && !this->pending_ && level == this->sent_level_)
+    return;
+  this->level_ = level;
+  this->pending_ = true;
+  this->flush_();
+}
+
+void UARTPINFloatChannel::flush_() {
+  if (!this->pending_ || !this->parent_->is_ready())
+    return;
+  // don't flood slow links while a transition is running, only the latest level is sent
+  const uint32_t now = millis();
+  if (this->sent_ && now - this->last_write_ < this->min_interval_)
+    return;
+  this->pending_ = false;
+  if (this->sent_ && this->level_ == this->sent_level_)
+    return;
+
+  if (this->level_size_ == 2) {
+    this->frame_[this->level_offset_] = this->level_ >> 8;
+    this->frame_[this->level_offset_ + 1] = this->level_ & 0xFF;
+  } else {
+    this->frame_[this->level_offset_] = this->level_ & 0xFF;
+  }
+  if (this->checksum_ != UARTPIN_CHECKSUM_NONE) {
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < this->checksum_offset_; i++) {
+      if (this->checksum_ == UARTPIN_CHECKSUM_SUM)
+        crc += this->frame_[i];
+      else
+        crc ^= this->frame_[i];
+    }
+    this->frame_[this->checksum_offset_] = crc;
+  }
+
+  this->parent_->write_to_uart(this->frame_);
+  this->sent_level_ = this->level_;
+  this->sent_ = true;
+  this->last_write_ = now;
+}
+
 }  // namespace uartpin
 }  // namespace esphome
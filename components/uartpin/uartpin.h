@@ -1,19 +1,25 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/output/binary_output.h"
+#include "esphome/components/output/float_output.h"
 #include "esphome/components/uart/uart.h"
 
 namespace esphome {
 namespace uartpin {
 
+enum UARTPINChecksum { UARTPIN_CHECKSUM_NONE, UARTPIN_CHECKSUM_SUM, UARTPIN_CHECKSUM_XOR };
+
 class UARTPINChannel;
+class UARTPINFloatChannel;
 
 class UARTPINComponent : public Component, public uart::UARTDevice {
  public:
   UARTPINComponent() {}
 
   UARTPINChannel *create_channel();
+  UARTPINFloatChannel *create_float_channel();
 
   void setup() override;
   void dump_config() override;
@@ -21,15 +27,48 @@ class UARTPINComponent : public Component, public uart::UARTDevice {
   float get_setup_priority() const override { return setup_priority::HARDWARE; }
   void set_init_data(const std::vector<uint8_t> &data);
   void set_init_delay(unsigned int delay);
+  void set_tx_buffer_size(size_t size) { this->tx_buffer_size_ = size; }
+  void set_tx_fifo_size(size_t size) { this->tx_fifo_size_ = size; }
+
+  /// Queue data for transmission, on_sent is called once its last byte was handed to the UART.
+  void write_to_uart(const std::vector<uint8_t> &data, std::function<void()> &&on_sent);
+  size_t get_tx_queued() const { return this->tx_count_; }
+  size_t get_tx_queued_max() const { return this->tx_count_max_; }
+  uint32_t get_tx_max_blocking_us() const { return this->tx_max_blocking_us_; }
 
  protected:
   friend UARTPINChannel;
+  friend UARTPINFloatChannel;
   void write_to_uart(const std::vector<uint8_t> &data);
+  bool is_ready() const { return this->init_; }
+  // Hand queued bytes to the UART at the line rate, never more than the FIFO can take
+  void service_tx_();
+  void drain_tx_(size_t max_bytes);
 
  private:
   std::vector<uint8_t> init_data_;
+  std::vector<UARTPINFloatChannel *> float_channels_;
   unsigned int init_delay_ = 0;
   bool init_ = false;
+
+  // TX ring buffer
+  std::vector<uint8_t> tx_buffer_;
+  size_t tx_buffer_size_ = 256;
+  size_t tx_fifo_size_ = 128;
+  size_t tx_head_ = 0;
+  size_t tx_tail_ = 0;
+  size_t tx_count_ = 0;
+  uint32_t tx_last_us_ = 0;
+  // running byte counters, used to fire completion callbacks
+  uint32_t tx_queued_total_ = 0;
+  uint32_t tx_sent_total_ = 0;
+  std::vector<std::pair<uint32_t, std::function<void()>>> tx_callbacks_;
+  HighFrequencyLoopRequester high_freq_;
+
+  // TX stats
+  size_t tx_count_max_ = 0;
+  uint32_t tx_max_blocking_us_ = 0;
+  uint32_t tx_overflows_ = 0;
 };
 
 class UARTPINChannel : public output::BinaryOutput {
@@ -48,5 +87,39 @@ class UARTPINChannel : public output::BinaryOutput {
   UARTPINComponent *parent_;
 };
 
+/// Multi-level channel: the output level is quantised into a frame template.
+class UARTPINFloatChannel : public output::FloatOutput {
+ public:
+  UARTPINFloatChannel(UARTPINComponent *parent) : parent_(parent) {}
+  void set_data_template(const std::vector<uint8_t> &data);
+  void set_level_offset(uint8_t offset) { this->level_offset_ = offset; }
+  void set_level_size(uint8_t size) { this->level_size_ = size; }
+  void set_level_range(uint16_t min_level, uint16_t max_level);
+  void set_checksum(UARTPINChecksum checksum, uint8_t offset);
+  void set_min_interval(uint32_t min_interval) { this->min_interval_ = min_interval; }
+
+ protected:
+  friend UARTPINComponent;
+  void write_state(float state) override;
+  // Send the pending level if the rate limit allows it
+  void flush_();
+
+  std::vector<uint8_t> frame_;
+  uint8_t level_offset_ = 0;
+  uint8_t level_size_ = 1;
+  uint16_t min_level_ = 0;
+  uint16_t max_level_ = 255;
+  UARTPINChecksum checksum_ = UARTPIN_CHECKSUM_NONE;
+  uint8_t checksum_offset_ = 0;
+  uint32_t min_interval_ = 0;
+
+  uint16_t level_ = 0;
+  uint16_t sent_level_ = 0;
+  bool sent_ = false;
+  bool pending_ = false;
+  uint32_t last_write_ = 0;
+  UARTPINComponent *parent_;
+};
+
 }  // namespace uartpin
 }  // namespace esphome
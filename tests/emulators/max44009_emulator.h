@@ -0,0 +1,82 @@
+#pragma once
+
+// Register-level MAX44009 emulator: configuration register and the lux reading encoded as
+// exponent/mantissa, with the overflow exponent.
+
+#include <cmath>
+
+#include "harness.h"
+
+namespace esphome {
+namespace test {
+
+class MAX44009Emulator : public RegisterDeviceEmulator {
+ public:
+  static const uint8_t REG_CONFIGURATION = 0x02;
+  static const uint8_t REG_LUX_HIGH = 0x03;
+  static const uint8_t REG_LUX_LOW = 0x04;
+  static const uint8_t CFG_CONTINUOUS = 0x80;
+
+  explicit MAX44009Emulator(uint8_t address = 0x4A) : RegisterDeviceEmulator(address) {}
+
+  /// Lux of the next readings, NAN reads as the overflow code.
+  void set_lux(float lux) { this->lux_ = lux; }
+  uint8_t get_configuration() const { return this->config_; }
+  void set_configuration(uint8_t config) { this->config_ = config; }
+  bool is_continuous() const { return (this->config_ & CFG_CONTINUOUS) != 0; }
+  uint32_t get_configuration_writes() const { return this->config_writes_; }
+  uint32_t get_lux_reads() const { return this->lux_reads_; }
+
+  /// Exponent/mantissa encoding, 0.045 lx per count of the mantissa at exponent 0.
+  static void encode(float lux, uint8_t *high, uint8_t *low) {
+    if (std::isnan(lux)) {
+      *high = 0xF0;
+      *low = 0;
+      return;
+    }
+    uint8_t exponent = 0;
+    uint32_t mantissa = static_cast<uint32_t>(lux / 0.045f + 0.5f);
+    while (mantissa > 0xFF && exponent < 14) {
+      exponent++;
+      mantissa = static_cast<uint32_t>(lux / (0.045f * (1 << exponent)) + 0.5f);
+    }
+    if (mantissa > 0xFF)
+      mantissa = 0xFF;
+    *high = (exponent << 4) | (mantissa >> 4);
+    *low = mantissa & 0x0F;
+  }
+
+ protected:
+  uint8_t read_register_(uint8_t reg) override {
+    uint8_t high, low;
+    switch (reg) {
+      case REG_CONFIGURATION:
+        return this->config_;
+      case REG_LUX_HIGH:
+        this->lux_reads_++;
+        encode(this->lux_, &high, &low);
+        return high;
+      case REG_LUX_LOW:
+        encode(this->lux_, &high, &low);
+        return low;
+      default:
+        return 0;
+    }
+  }
+
+  void write_register_(uint8_t reg, uint8_t value) override {
+    if (reg == REG_CONFIGURATION) {
+      this->config_ = value;
+      this->config_writes_++;
+    }
+  }
+
+  float lux_{100};
+  // power-on default: automatic mode, 800ms cycle
+  uint8_t config_{0x03};
+  uint32_t config_writes_{0};
+  uint32_t lux_reads_{0};
+};
+
+}  // namespace test
+}  // namespace esphome
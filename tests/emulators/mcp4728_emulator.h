@@ -0,0 +1,183 @@
+#pragma once
+
+// MCP4728 emulator: decodes fast, multi, sequential and single writes and the Vref/gain/power-down
+// select commands into the DAC input registers, outputs and EEPROM, with UDAC/LDAC latching and
+// the 24-byte register readback.
+
+#include <vector>
+
+#include "harness.h"
+
+namespace esphome {
+namespace test {
+
+class MCP4728Emulator : public I2CDeviceEmulator {
+ public:
+  struct Channel {
+    uint8_t vref;
+    uint8_t pd;
+    uint8_t gain;
+    uint16_t data;
+
+    bool operator==(const Channel &other) const {
+      return vref == other.vref && pd == other.pd && gain == other.gain && data == other.data;
+    }
+  };
+  enum Command { FAST, MULTI, SEQUENTIAL, SINGLE, VREF, GAIN, POWER_DOWN };
+
+  explicit MCP4728Emulator(uint8_t address = 0x60) : I2CDeviceEmulator(address) {
+    for (auto &ch : this->eeprom_)
+      ch = Channel{0, 0, 0, 0};
+    this->power_cycle();
+  }
+
+  /// Power-on: the input registers and outputs load the EEPROM.
+  void power_cycle() {
+    for (uint8_t i = 0; i < 4; i++)
+      this->input_[i] = this->output_[i] = this->eeprom_[i];
+  }
+  void set_eeprom(uint8_t channel, Channel value) { this->eeprom_[channel] = value; }
+
+  /// Follow an LDAC line: a falling edge latches the input registers to the outputs, and writes
+  /// go straight to the outputs while it's low. Without it, LDAC is tied low unless set_ldac_high().
+  void attach_ldac(FakePin *pin) {
+    this->ldac_high_ = pin->value;
+    pin->on_write = [this](bool value) {
+      if (this->ldac_high_ && !value)
+        this->latch_all_();
+      this->ldac_high_ = value;
+    };
+  }
+
+  /// LDAC pulled high without a pin: only writes with UDAC clear reach the outputs.
+  void set_ldac_high(bool high) { this->ldac_high_ = high; }
+
+  const Channel &input(uint8_t channel) const { return this->input_[channel]; }
+  const Channel &output(uint8_t channel) const { return this->output_[channel]; }
+  const Channel &eeprom(uint8_t channel) const { return this->eeprom_[channel]; }
+  /// Decoded commands, one entry per channel update of a write.
+  const std::vector<Command> &commands() const { return this->commands_; }
+  uint32_t get_writes() const { return this->writes_; }
+  uint32_t get_latches() const { return this->latches_; }
+  void clear_log() {
+    this->commands_.clear();
+    this->writes_ = 0;
+    this->latches_ = 0;
+  }
+
+  bool on_write(const uint8_t *data, size_t len) override {
+    this->writes_++;
+    size_t i = 0;
+    while (i < len) {
+      const uint8_t c = data[i];
+      if ((c & 0xC0) == 0x00) {
+        // fast write: two bytes per channel, A to D
+        for (uint8_t ch = 0; ch < 4 && i + 1 < len; ch++, i += 2) {
+          this->input_[ch].pd = (data[i] >> 4) & 0x03;
+          this->input_[ch].data = ((data[i] & 0x0F) << 8) | data[i + 1];
+          this->commands_.push_back(FAST);
+          // no UDAC bit, the outputs follow LDAC
+          this->update_(ch, true);
+        }
+      } else if ((c & 0xF8) == 0x40) {
+        // multi write: command byte per channel
+        if (i + 2 >= len)
+          return false;
+        const uint8_t ch = (c >> 1) & 0x03;
+        this->decode_(ch, data[i + 1], data[i + 2]);
+        this->commands_.push_back(MULTI);
+        this->update_(ch, c & 0x01);
+        i += 3;
+      } else if ((c & 0xF8) == 0x50) {
+        // sequential write: from the channel up to D, to EEPROM too
+        const bool udac = c & 0x01;
+        i++;
+        for (uint8_t ch = (c >> 1) & 0x03; ch < 4 && i + 1 < len; ch++, i += 2) {
+          this->decode_(ch, data[i], data[i + 1]);
+          this->eeprom_[ch] = this->input_[ch];
+          this->commands_.push_back(SEQUENTIAL);
+          this->update_(ch, udac);
+        }
+      } else if ((c & 0xF8) == 0x58) {
+        // single write, to EEPROM too
+        if (i + 2 >= len)
+          return false;
+        const uint8_t ch = (c >> 1) & 0x03;
+        this->decode_(ch, data[i + 1], data[i + 2]);
+        this->eeprom_[ch] = this->input_[ch];
+        this->commands_.push_back(SINGLE);
+        this->update_(ch, c & 0x01);
+        i += 3;
+      } else if ((c & 0xE0) == 0x80) {
+        for (uint8_t ch = 0; ch < 4; ch++)
+          this->input_[ch].vref = this->output_[ch].vref = (c >> (3 - ch)) & 0x01;
+        this->commands_.push_back(VREF);
+        i++;
+      } else if ((c & 0xE0) == 0xC0) {
+        for (uint8_t ch = 0; ch < 4; ch++)
+          this->input_[ch].gain = this->output_[ch].gain = (c >> (3 - ch)) & 0x01;
+        this->commands_.push_back(GAIN);
+        i++;
+      } else if ((c & 0xE0) == 0xA0) {
+        if (i + 1 >= len)
+          return false;
+        const uint16_t bits = ((c & 0x0F) << 8) | data[i + 1];
+        for (uint8_t ch = 0; ch < 4; ch++)
+          this->input_[ch].pd = this->output_[ch].pd = (bits >> (10 - ch * 2)) & 0x03;
+        this->commands_.push_back(POWER_DOWN);
+        i += 2;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool on_read(uint8_t *data, size_t len) override {
+    uint8_t buf[24];
+    for (uint8_t ch = 0; ch < 4; ch++) {
+      encode_(&buf[ch * 6], ch, this->input_[ch], false);
+      encode_(&buf[ch * 6 + 3], ch, this->eeprom_[ch], true);
+    }
+    for (size_t i = 0; i < len; i++)
+      data[i] = buf[i % 24];
+    return true;
+  }
+
+ protected:
+  void decode_(uint8_t ch, uint8_t b1, uint8_t b2) {
+    this->input_[ch].vref = b1 >> 7;
+    this->input_[ch].pd = (b1 >> 5) & 0x03;
+    this->input_[ch].gain = (b1 >> 4) & 0x01;
+    this->input_[ch].data = ((b1 & 0x0F) << 8) | b2;
+  }
+
+  static void encode_(uint8_t *buf, uint8_t ch, const Channel &value, bool eeprom) {
+    // RDY, POR, channel, EEPROM flag
+    buf[0] = 0xC0 | (ch << 4) | (eeprom ? 0x08 : 0x00);
+    buf[1] = (value.vref << 7) | (value.pd << 5) | (value.gain << 4) | (value.data >> 8);
+    buf[2] = value.data & 0xFF;
+  }
+
+  void update_(uint8_t ch, bool udac) {
+    if (!udac || !this->ldac_high_)
+      this->output_[ch] = this->input_[ch];
+  }
+
+  void latch_all_() {
+    this->latches_++;
+    for (uint8_t ch = 0; ch < 4; ch++)
+      this->output_[ch] = this->input_[ch];
+  }
+
+  Channel input_[4];
+  Channel output_[4];
+  Channel eeprom_[4];
+  bool ldac_high_{false};
+  std::vector<Command> commands_;
+  uint32_t writes_{0};
+  uint32_t latches_{0};
+};
+
+}  // namespace test
+}  // namespace esphome
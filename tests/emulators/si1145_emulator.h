@@ -0,0 +1,241 @@
+#pragma once
+
+// Register-level SI1145 emulator: register file, parameter RAM behind the command/response
+// interface, forced and autonomous ALS conversions with range/gain scaling, integration time and
+// overflow codes, bus address change and power gating through an enable line.
+
+#include <cstring>
+#include <functional>
+
+#include "harness.h"
+
+namespace esphome {
+namespace test {
+
+class SI1145Emulator : public RegisterDeviceEmulator {
+ public:
+  static const uint8_t DEFAULT_ADDRESS = 0x60;
+  // the chip loses its state when its supply is off for longer than this
+  static const uint32_t POWER_OFF_RESET_US = 10000;
+
+  explicit SI1145Emulator(uint8_t address = DEFAULT_ADDRESS) : RegisterDeviceEmulator(address) {
+    this->power_on_reset_();
+  }
+
+  /// Light in counts above the dark offset, at low range and gain 0.
+  void set_light(float visible, float infrared) {
+    this->visible_ = visible;
+    this->infrared_ = infrared;
+  }
+  /// Visible light as a function of time (us), overrides set_light() for the visible channel.
+  void set_visible_waveform(std::function<float(uint64_t)> waveform) { this->visible_waveform_ = std::move(waveform); }
+  void set_uv_index(float uv_index) { this->uv_index_ = uv_index; }
+
+  /// Follow an enable line: the chip is powered while it's high.
+  void attach_enable(FakePin *pin) {
+    this->set_powered(pin->value);
+    pin->on_write = [this](bool value) { this->set_powered(value); };
+  }
+  void set_powered(bool powered) {
+    if (powered == this->powered_)
+      return;
+    this->powered_ = powered;
+    if (!powered) {
+      this->off_since_ = now_us();
+    } else if (now_us() - this->off_since_ >= POWER_OFF_RESET_US) {
+      this->power_on_reset_();
+    }
+  }
+  bool is_present() const override { return this->powered_; }
+  /// Move the chip as BUSADDR does, e.g. to an address it kept across an ESP reset.
+  void set_address(uint8_t address) { this->address_ = address; }
+
+  uint8_t get_param(uint8_t param) const { return this->params_[param & 0x1F]; }
+  uint8_t get_register(uint8_t reg) const { return this->regs_[reg]; }
+  bool is_autonomous() const { return this->autonomous_; }
+  uint32_t get_resets() const { return this->resets_; }
+  uint32_t get_commands() const { return this->commands_; }
+  uint32_t get_visible_reads() const { return this->visible_reads_; }
+
+ protected:
+  static const uint8_t REG_PARTID = 0x00;
+  static const uint8_t REG_PARAMWR = 0x17;
+  static const uint8_t REG_COMMAND = 0x18;
+  static const uint8_t REG_RESPONSE = 0x20;
+  static const uint8_t REG_IRQSTAT = 0x21;
+  static const uint8_t REG_ALSVISDATA0 = 0x22;
+  static const uint8_t REG_ALSIRDATA0 = 0x24;
+  static const uint8_t REG_UVINDEX0 = 0x2C;
+  static const uint8_t REG_PARAMRD = 0x2E;
+  static const uint8_t PARAM_I2CADDR = 0x00;
+  static const uint8_t PARAM_ALSIRADCGAIN = 0x1E;
+  static const uint8_t PARAM_ALSIRADCMISC = 0x1F;
+  static const uint8_t PARAM_ALSVISADCGAIN = 0x11;
+  static const uint8_t PARAM_ALSVISADCMISC = 0x12;
+  static const uint8_t RANGE_HIGH = 0x20;
+
+  void power_on_reset_() {
+    this->address_ = DEFAULT_ADDRESS;
+    this->reset_();
+  }
+
+  void reset_() {
+    memset(this->regs_, 0, sizeof(this->regs_));
+    memset(this->params_, 0, sizeof(this->params_));
+    this->regs_[REG_PARTID] = 0x45;
+    this->params_[PARAM_I2CADDR] = DEFAULT_ADDRESS;
+    this->autonomous_ = false;
+    this->counter_ = 0;
+    this->resets_++;
+  }
+
+  uint8_t read_register_(uint8_t reg) override {
+    if (reg == REG_ALSVISDATA0 || reg == REG_ALSVISDATA0 + 1) {
+      if (reg == REG_ALSVISDATA0)
+        this->visible_reads_++;
+      // autonomous mode converts continuously, a read returns the latest conversion
+      if (this->autonomous_)
+        this->convert_(false);
+    }
+    return this->regs_[reg & 0x3F];
+  }
+
+  void write_register_(uint8_t reg, uint8_t value) override {
+    reg &= 0x3F;
+    if (reg == REG_COMMAND) {
+      this->regs_[reg] = value;
+      this->command_(value);
+    } else if (reg == REG_IRQSTAT) {
+      // write one to clear
+      this->regs_[reg] &= ~value;
+    } else if (reg != REG_PARTID && reg != REG_RESPONSE) {
+      this->regs_[reg] = value;
+    }
+  }
+
+  void respond_() { this->regs_[REG_RESPONSE] = (++this->counter_) & 0x0F; }
+
+  void command_(uint8_t command) {
+    this->commands_++;
+    if ((command & 0xE0) == 0xA0) {
+      // PARAM_SET
+      this->params_[command & 0x1F] = this->regs_[REG_PARAMWR];
+      this->regs_[REG_PARAMRD] = this->regs_[REG_PARAMWR];
+      this->respond_();
+      return;
+    }
+    if ((command & 0xE0) == 0x80) {
+      // PARAM_QUERY
+      this->regs_[REG_PARAMRD] = this->params_[command & 0x1F];
+      this->respond_();
+      return;
+    }
+    switch (command) {
+      case 0x00:  // NOP clears the response and any error
+        this->regs_[REG_RESPONSE] = 0;
+        this->counter_ = 0;
+        break;
+      case 0x01:  // RESET
+        this->reset_();
+        break;
+      case 0x02:  // BUSADDR
+        this->address_ = this->params_[PARAM_I2CADDR];
+        this->respond_();
+        break;
+      case 0x05:  // PS_FORCE
+        this->respond_();
+        break;
+      case 0x06:  // ALS_FORCE
+        this->convert_(true);
+        break;
+      case 0x07:  // PSALS_FORCE
+        this->convert_(true);
+        break;
+      case 0x09:  // PS_PAUSE
+      case 0x0A:  // ALS_PAUSE
+      case 0x0B:  // PSALS_PAUSE
+        this->autonomous_ = false;
+        this->respond_();
+        break;
+      case 0x0D:  // PS_AUTO
+      case 0x0E:  // ALS_AUTO
+      case 0x0F:  // PSALS_AUTO
+        this->autonomous_ = true;
+        this->respond_();
+        break;
+      case 0x12:  // GET_CAL
+        this->respond_();
+        break;
+      default:
+        // invalid command
+        this->regs_[REG_RESPONSE] = 0x80;
+        break;
+    }
+  }
+
+  static uint32_t scale_(float light, uint8_t gain, uint8_t misc, uint16_t zero) {
+    float counts = light * (1 << (gain & 0x07));
+    if (misc & RANGE_HIGH)
+      counts /= 14.5f;
+    return zero + static_cast<uint32_t>(counts < 0 ? 0 : counts);
+  }
+
+  // The ADC integrates over 25.6us doubled per gain step, a conversion averages the light over
+  // that window: a long integration smooths out fast flicker.
+  float visible_light_() const {
+    if (!this->visible_waveform_)
+      return this->visible_;
+    const uint64_t now = now_us();
+    const uint32_t window = (256u << (this->params_[PARAM_ALSVISADCGAIN] & 0x07)) / 10;
+    const uint64_t start = now > window ? now - window : 0;
+    float sum = 0;
+    for (uint32_t i = 0; i < 8; i++)
+      sum += this->visible_waveform_(start + window * (2 * i + 1) / 16);
+    return sum / 8;
+  }
+
+  void convert_(bool forced) {
+    const float visible = this->visible_light_();
+    const uint8_t vis_misc = this->params_[PARAM_ALSVISADCMISC];
+    const uint8_t ir_misc = this->params_[PARAM_ALSIRADCMISC];
+    const uint32_t vis = scale_(visible, this->params_[PARAM_ALSVISADCGAIN], vis_misc, vis_misc & RANGE_HIGH ? 260 : 270);
+    const uint32_t ir = scale_(this->infrared_, this->params_[PARAM_ALSIRADCGAIN], ir_misc, ir_misc & RANGE_HIGH ? 260 : 270);
+    const uint16_t vis16 = vis > 0xFFFF ? 0xFFFF : vis;
+    const uint16_t ir16 = ir > 0xFFFF ? 0xFFFF : ir;
+    this->regs_[REG_ALSVISDATA0] = vis16 & 0xFF;
+    this->regs_[REG_ALSVISDATA0 + 1] = vis16 >> 8;
+    this->regs_[REG_ALSIRDATA0] = ir16 & 0xFF;
+    this->regs_[REG_ALSIRDATA0 + 1] = ir16 >> 8;
+    const uint16_t uv = static_cast<uint16_t>(this->uv_index_ * 100);
+    this->regs_[REG_UVINDEX0] = uv & 0xFF;
+    this->regs_[REG_UVINDEX0 + 1] = uv >> 8;
+    this->regs_[REG_IRQSTAT] |= 0x01;
+    if (!forced)
+      return;
+    // an overflowing ADC reports an error code until the next NOP
+    if (vis > 0xFFFF) {
+      this->regs_[REG_RESPONSE] = 0x8C;
+    } else if (ir > 0xFFFF) {
+      this->regs_[REG_RESPONSE] = 0x8D;
+    } else {
+      this->respond_();
+    }
+  }
+
+  uint8_t regs_[0x40];
+  uint8_t params_[0x20];
+  uint8_t counter_{0};
+  bool autonomous_{false};
+  bool powered_{true};
+  uint64_t off_since_{0};
+  float visible_{1000};
+  float infrared_{1000};
+  float uv_index_{0};
+  std::function<float(uint64_t)> visible_waveform_;
+  uint32_t resets_{0};
+  uint32_t commands_{0};
+  uint32_t visible_reads_{0};
+};
+
+}  // namespace test
+}  // namespace esphome
@@ -0,0 +1,77 @@
+#pragma once
+
+// UART sink: records every byte with the time it was handed over, and models the hardware TX FIFO
+// draining at the line rate (10 bits per byte), so a write larger than the free FIFO space blocks
+// like the real write_array().
+
+#include <algorithm>
+#include <vector>
+
+#include "esphome/components/uart/uart.h"
+#include "harness.h"
+
+namespace esphome {
+namespace test {
+
+class UARTSink : public uart::UARTComponent {
+ public:
+  struct Byte {
+    uint64_t time_us;
+    uint8_t value;
+  };
+
+  explicit UARTSink(uint32_t baud_rate = 9600, size_t fifo_size = 128) : fifo_size_(fifo_size) {
+    this->baud_rate_ = baud_rate;
+  }
+
+  void write_array(const uint8_t *data, size_t len) override {
+    this->calls_++;
+    for (size_t i = 0; i < len; i++) {
+      this->drain_();
+      if (this->fifo_level_ >= this->fifo_size_) {
+        // wait for one byte to leave the FIFO
+        advance_us(this->byte_time_us_() - (now_us() - this->drained_at_));
+        this->drain_();
+      }
+      this->fifo_level_++;
+      this->bytes_.push_back(Byte{now_us(), data[i]});
+    }
+  }
+
+  const std::vector<Byte> &bytes() const { return this->bytes_; }
+  std::vector<uint8_t> values() const {
+    std::vector<uint8_t> out;
+    for (const auto &b : this->bytes_)
+      out.push_back(b.value);
+    return out;
+  }
+  uint32_t get_calls() const { return this->calls_; }
+  void clear() {
+    this->bytes_.clear();
+    this->calls_ = 0;
+  }
+
+ protected:
+  uint64_t byte_time_us_() const { return 10000000ULL / this->baud_rate_; }
+
+  void drain_() {
+    const uint64_t t = this->byte_time_us_();
+    if (this->fifo_level_ == 0) {
+      this->drained_at_ = now_us();
+      return;
+    }
+    const uint64_t sent = (now_us() - this->drained_at_) / t;
+    const size_t n = std::min<uint64_t>(sent, this->fifo_level_);
+    this->fifo_level_ -= n;
+    this->drained_at_ = this->fifo_level_ == 0 ? now_us() : this->drained_at_ + n * t;
+  }
+
+  size_t fifo_size_;
+  size_t fifo_level_{0};
+  uint64_t drained_at_{0};
+  std::vector<Byte> bytes_;
+  uint32_t calls_{0};
+};
+
+}  // namespace test
+}  // namespace esphome
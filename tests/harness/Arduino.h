@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for the Arduino core, only what the components use.
+
+#include <cmath>
+#include <cstdint>
+
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define lowByte(w) ((uint8_t)((w) &0xff))
+
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF attributes, RTC memory is plain memory on the host.
+
+#define RTC_DATA_ATTR
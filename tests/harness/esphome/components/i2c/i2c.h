@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+  ERROR_OK = 0,
+  ERROR_INVALID_ARGUMENT = 1,
+  ERROR_NOT_ACKNOWLEDGED = 2,
+  ERROR_TIMEOUT = 3,
+  ERROR_NOT_INITIALIZED = 4,
+  ERROR_TOO_LARGE = 5,
+  ERROR_UNKNOWN = 6,
+};
+
+/// Bus interface, implemented on the host by test::I2CBusEmulator.
+class I2CBus {
+ public:
+  virtual ~I2CBus() = default;
+  virtual ErrorCode read(uint8_t address, uint8_t *data, size_t len) = 0;
+  virtual ErrorCode write(uint8_t address, const uint8_t *data, size_t len, bool stop) = 0;
+};
+
+/// Same helpers as ESPHome's I2CDevice: a register read writes the register address, then reads.
+class I2CDevice {
+ public:
+  void set_i2c_address(uint8_t address) { this->address_ = address; }
+  void set_i2c_bus(I2CBus *bus) { this->bus_ = bus; }
+  uint8_t get_i2c_address() const { return this->address_; }
+
+  ErrorCode read(uint8_t *data, size_t len) { return this->bus_->read(this->address_, data, len); }
+  ErrorCode write(const uint8_t *data, uint8_t len, bool stop = true) {
+    return this->bus_->write(this->address_, data, len, stop);
+  }
+
+  ErrorCode read_register(uint8_t a_register, uint8_t *data, size_t len, bool stop = true) {
+    ErrorCode err = this->write(&a_register, 1, stop);
+    if (err != ERROR_OK)
+      return err;
+    return this->read(data, len);
+  }
+  ErrorCode write_register(uint8_t a_register, const uint8_t *data, size_t len, bool stop = true) {
+    std::vector<uint8_t> buf(len + 1);
+    buf[0] = a_register;
+    for (size_t i = 0; i < len; i++)
+      buf[i + 1] = data[i];
+    return this->bus_->write(this->address_, buf.data(), buf.size(), stop);
+  }
+
+  bool read_bytes(uint8_t a_register, uint8_t *data, uint8_t len) {
+    return this->read_register(a_register, data, len) == ERROR_OK;
+  }
+  bool read_byte(uint8_t a_register, uint8_t *data, bool stop = true) {
+    return this->read_register(a_register, data, 1, stop) == ERROR_OK;
+  }
+  bool read_byte_16(uint8_t a_register, uint16_t *data) {
+    uint8_t buf[2];
+    if (!this->read_bytes(a_register, buf, 2))
+      return false;
+    *data = (buf[0] << 8) | buf[1];
+    return true;
+  }
+  bool write_bytes(uint8_t a_register, const uint8_t *data, uint8_t len) {
+    return this->write_register(a_register, data, len) == ERROR_OK;
+  }
+  bool write_byte(uint8_t a_register, uint8_t data) { return this->write_register(a_register, &data, 1) == ERROR_OK; }
+
+ protected:
+  uint8_t address_{0x00};
+  I2CBus *bus_{nullptr};
+};
+
+}  // namespace i2c
+}  // namespace esphome
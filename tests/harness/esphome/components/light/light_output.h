@@ -0,0 +1,17 @@
+#pragma once
+
+#include "esphome/components/light/light_state.h"
+
+namespace esphome {
+namespace light {
+
+class LightOutput {
+ public:
+  virtual ~LightOutput() = default;
+  virtual LightTraits get_traits() = 0;
+  virtual void setup_state(LightState *state) {}
+  virtual void write_state(LightState *state) = 0;
+};
+
+}  // namespace light
+}  // namespace esphome
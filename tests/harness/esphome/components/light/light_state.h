@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+namespace esphome {
+namespace light {
+
+enum class ColorMode : uint8_t {
+  UNKNOWN,
+  ON_OFF,
+  BRIGHTNESS,
+  WHITE,
+  COLOR_TEMPERATURE,
+  COLD_WARM_WHITE,
+  RGB,
+  RGB_WHITE,
+  RGB_COLOR_TEMPERATURE,
+  RGB_COLD_WARM_WHITE,
+};
+
+class LightTraits {
+ public:
+  void set_supported_color_modes(std::set<ColorMode> modes) { this->supported_color_modes_ = modes; }
+  const std::set<ColorMode> &get_supported_color_modes() const { return this->supported_color_modes_; }
+  void set_min_mireds(float min_mireds) { this->min_mireds_ = min_mireds; }
+  void set_max_mireds(float max_mireds) { this->max_mireds_ = max_mireds; }
+  float get_min_mireds() const { return this->min_mireds_; }
+  float get_max_mireds() const { return this->max_mireds_; }
+
+ protected:
+  std::set<ColorMode> supported_color_modes_;
+  float min_mireds_{0};
+  float max_mireds_{0};
+};
+
+/// Host stand-in for LightState: the current values are set directly by the tests, in the order
+/// of the current_values_as_*() call used by the output.
+class LightState {
+ public:
+  void set_values(float a, float b, float c = 0.0f, float d = 0.0f) {
+    this->values_[0] = a;
+    this->values_[1] = b;
+    this->values_[2] = c;
+    this->values_[3] = d;
+  }
+
+  void current_values_as_rgb(float *red, float *green, float *blue, bool color_interlock = false) {
+    *red = this->values_[0];
+    *green = this->values_[1];
+    *blue = this->values_[2];
+  }
+  void current_values_as_rgbw(float *red, float *green, float *blue, float *white, bool color_interlock = false) {
+    this->current_values_as_rgb(red, green, blue);
+    *white = this->values_[3];
+  }
+  void current_values_as_cwww(float *cold_white, float *warm_white, bool constant_brightness = false) {
+    *cold_white = this->values_[0];
+    *warm_white = this->values_[1];
+  }
+
+ protected:
+  float values_[4]{};
+};
+
+}  // namespace light
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/components/output/binary_output.h"
+
+namespace esphome {
+namespace output {
+
+class FloatOutput : public BinaryOutput {
+ public:
+  void set_level(float state) {
+    if (state < 0.0f)
+      state = 0.0f;
+    if (state > 1.0f)
+      state = 1.0f;
+    this->write_state(state);
+  }
+
+ protected:
+  void write_state(bool state) override { this->set_level(state ? 1.0f : 0.0f); }
+  virtual void write_state(float state) = 0;
+};
+
+}  // namespace output
+}  // namespace esphome
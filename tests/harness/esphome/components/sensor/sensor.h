@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace sensor {
+
+/// Host stand-in for ESPHome's Sensor, without filters. Every published value is kept in
+/// `published` for the tests.
+class Sensor {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->published.push_back(state);
+    for (auto &cb : this->callbacks_)
+      cb(state);
+  }
+  float get_state() const { return this->state; }
+  bool has_state() const { return this->has_state_; }
+  void add_on_state_callback(std::function<void(float)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+
+  float state{NAN};
+  std::vector<float> published;
+
+ protected:
+  bool has_state_{false};
+  std::vector<std::function<void(float)>> callbacks_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace uart {
+
+/// UART interface, implemented on the host by test::UARTSink.
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual void flush() {}
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+
+ protected:
+  uint32_t baud_rate_{9600};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  void write_array(const std::vector<uint8_t> &data) { this->parent_->write_array(data.data(), data.size()); }
+  void flush() { this->parent_->flush(); }
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
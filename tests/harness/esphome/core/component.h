@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float BUS;
+extern const float IO;
+extern const float HARDWARE;
+extern const float DATA;
+extern const float PROCESSOR;
+extern const float AFTER_WIFI;
+extern const float LATE;
+}  // namespace setup_priority
+
+/// Host stand-in for ESPHome's Component. Timeouts, intervals and deferred calls go to the
+/// emulated scheduler run by test::loop().
+class Component {
+ public:
+  virtual ~Component();
+
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const;
+  /// setup() plus what the application does around it (starts the poller of a PollingComponent).
+  virtual void call_setup();
+
+  bool is_failed() const { return this->failed_; }
+  void mark_failed() { this->failed_ = true; }
+  void status_set_warning(const char *message = "unspecified") { this->warning_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  void status_set_error(const char *message = "unspecified") { this->error_ = true; }
+  void status_clear_error() { this->error_ = false; }
+  bool status_has_warning() const { return this->warning_; }
+  bool status_has_error() const { return this->error_; }
+
+ protected:
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+  void set_interval(uint32_t interval, std::function<void()> &&f);
+  bool cancel_interval(const std::string &name);
+  void defer(std::function<void()> &&f);
+
+  bool failed_{false};
+  bool warning_{false};
+  bool error_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() : PollingComponent(0) {}
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+  virtual void update() = 0;
+  virtual void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  virtual uint32_t get_update_interval() const { return this->update_interval_; }
+  void call_setup() override;
+  void start_poller();
+  void stop_poller();
+
+ protected:
+  uint32_t update_interval_;
+};
+
+}  // namespace esphome
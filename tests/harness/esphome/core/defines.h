@@ -0,0 +1,7 @@
+#pragma once
+
+// Features the host build enables, as ESPHome's code generation would for a configuration using
+// the light platform and a bus scheduler. USE_ESP32 is left out so the preference paths are used.
+
+#define USE_BUS_SCHEDULER
+#define USE_LIGHT
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+// Emulated clock, see test::advance_us(). delay() advances it instead of sleeping.
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+namespace gpio {
+enum Flags : uint8_t {
+  FLAG_NONE = 0x00,
+  FLAG_INPUT = 0x01,
+  FLAG_OUTPUT = 0x02,
+  FLAG_OPEN_DRAIN = 0x04,
+  FLAG_PULLUP = 0x08,
+  FLAG_PULLDOWN = 0x10,
+};
+inline constexpr Flags operator|(Flags a, Flags b) {
+  return static_cast<Flags>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+}
+}  // namespace gpio
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() = 0;
+  virtual void pin_mode(gpio::Flags flags) = 0;
+  virtual bool digital_read() = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual std::string dump_summary() const = 0;
+};
+
+class InternalGPIOPin : public GPIOPin {};
+
+}  // namespace esphome
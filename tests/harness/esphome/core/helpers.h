@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+template<typename T> T clamp(T value, T min, T max) {
+  if (value < min)
+    return min;
+  if (value > max)
+    return max;
+  return value;
+}
+
+uint32_t fnv1_hash(const std::string &str);
+std::string format_hex(const uint8_t *data, size_t length);
+std::string format_hex_pretty(const uint8_t *data, size_t length);
+
+/// Asks the main loop to run without its 16ms pause, see test::loop_time_us().
+class HighFrequencyLoopRequester {
+ public:
+  void start();
+  void stop();
+  static bool is_high_frequency();
+
+ protected:
+  bool started_{false};
+  static uint32_t num_requests;  // NOLINT
+};
+
+template<typename... Ts> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &cb : this->callbacks_)
+      cb(args...);
+  }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+}  // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+
+// Log macros of the host build, printed only with ESPHOME_TEST_VERBOSE set in the environment.
+
+namespace esphome {
+namespace test {
+void log_printf(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+}  // namespace test
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::test::log_printf('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::test::log_printf('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::test::log_printf('I', tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::test::log_printf('D', tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ::esphome::test::log_printf('V', tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ::esphome::test::log_printf('V', tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ::esphome::test::log_printf('C', tag, __VA_ARGS__)
+
+#define LOG_I2C_DEVICE(this)
+#define LOG_SENSOR(prefix, type, obj)
+#define LOG_PIN(prefix, pin)
+#define LOG_UPDATE_INTERVAL(this)
+#define YESNO(b) ((b) ? "YES" : "NO")
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+namespace test {
+/// Backing store of the preferences, survives test::restart() like RTC memory survives a deep sleep.
+std::map<uint32_t, std::vector<uint8_t>> &preference_store();
+}  // namespace test
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(uint32_t type) : type_(type), valid_(true) {}
+
+  template<typename T> bool save(const T *src) {
+    if (!this->valid_)
+      return false;
+    auto &data = test::preference_store()[this->type_];
+    data.resize(sizeof(T));
+    memcpy(data.data(), src, sizeof(T));
+    return true;
+  }
+
+  template<typename T> bool load(T *dest) {
+    if (!this->valid_)
+      return false;
+    auto it = test::preference_store().find(this->type_);
+    if (it == test::preference_store().end() || it->second.size() != sizeof(T))
+      return false;
+    memcpy(dest, it->second.data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  uint32_t type_{0};
+  bool valid_{false};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    return ESPPreferenceObject(type);
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return ESPPreferenceObject(type); }
+};
+
+extern ESPPreferences *global_preferences;  // NOLINT
+
+}  // namespace esphome
@@ -0,0 +1,417 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+
+// ========== Clock ==========
+
+static uint64_t clock_us = 0;  // NOLINT
+
+uint32_t millis() { return static_cast<uint32_t>(clock_us / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(clock_us); }
+void delay(uint32_t ms) { clock_us += uint64_t(ms) * 1000; }
+void delayMicroseconds(uint32_t us) { clock_us += us; }
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0f;
+const float AFTER_WIFI = 200.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+// ========== Helpers ==========
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+std::string format_hex(const uint8_t *data, size_t length) {
+  static const char *const HEX_CHARS = "0123456789abcdef";
+  std::string ret;
+  for (size_t i = 0; i < length; i++) {
+    ret += HEX_CHARS[data[i] >> 4];
+    ret += HEX_CHARS[data[i] & 0x0F];
+  }
+  return ret;
+}
+
+std::string format_hex_pretty(const uint8_t *data, size_t length) {
+  std::string ret;
+  char buf[4];
+  for (size_t i = 0; i < length; i++) {
+    snprintf(buf, sizeof(buf), i == 0 ? "%02X" : ".%02X", data[i]);
+    ret += buf;
+  }
+  return ret;
+}
+
+uint32_t HighFrequencyLoopRequester::num_requests = 0;  // NOLINT
+
+void HighFrequencyLoopRequester::start() {
+  if (this->started_)
+    return;
+  num_requests++;
+  this->started_ = true;
+}
+
+void HighFrequencyLoopRequester::stop() {
+  if (!this->started_)
+    return;
+  num_requests--;
+  this->started_ = false;
+}
+
+bool HighFrequencyLoopRequester::is_high_frequency() { return num_requests > 0; }
+
+static ESPPreferences preferences_instance;         // NOLINT
+ESPPreferences *global_preferences = &preferences_instance;  // NOLINT
+
+// ========== Scheduler ==========
+
+namespace {
+
+struct ScheduledItem {
+  Component *component;
+  std::string name;
+  bool interval;
+  uint32_t period_ms;
+  uint64_t next_us;
+  uint64_t order;
+  std::function<void()> f;
+  bool removed;
+};
+
+std::vector<std::unique_ptr<ScheduledItem>> scheduled_items;  // NOLINT
+uint64_t scheduled_order = 0;                                  // NOLINT
+uint32_t loop_time_normal_us = 16000;                          // NOLINT
+uint32_t loop_time_high_frequency_us = 200;                    // NOLINT
+
+bool cancel_item(Component *component, const std::string &name, bool interval) {
+  bool found = false;
+  for (auto &item : scheduled_items) {
+    if (!item->removed && item->component == component && item->interval == interval && item->name == name) {
+      item->removed = true;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void add_item(Component *component, const std::string &name, bool interval, uint32_t ms, std::function<void()> &&f) {
+  if (!name.empty())
+    cancel_item(component, name, interval);
+  scheduled_items.emplace_back(new ScheduledItem{component, name, interval, ms, clock_us + uint64_t(ms) * 1000,
+                                                 scheduled_order++, std::move(f), false});
+}
+
+void run_scheduler() {
+  // items added while running are due on the next loop at the earliest
+  std::vector<ScheduledItem *> due;
+  for (auto &item : scheduled_items) {
+    if (!item->removed && item->next_us <= clock_us)
+      due.push_back(item.get());
+  }
+  std::sort(due.begin(), due.end(), [](const ScheduledItem *a, const ScheduledItem *b) {
+    return a->next_us != b->next_us ? a->next_us < b->next_us : a->order < b->order;
+  });
+  for (auto *item : due) {
+    if (item->removed)
+      continue;
+    if (item->component != nullptr && item->component->is_failed()) {
+      item->removed = true;
+      continue;
+    }
+    if (item->interval) {
+      item->next_us = clock_us + uint64_t(std::max<uint32_t>(item->period_ms, 1)) * 1000;
+    } else {
+      item->removed = true;
+    }
+    // the callback may add items, which would invalidate a copy of the function
+    std::function<void()> f = item->f;
+    f();
+  }
+  scheduled_items.erase(std::remove_if(scheduled_items.begin(), scheduled_items.end(),
+                                       [](const std::unique_ptr<ScheduledItem> &item) { return item->removed; }),
+                        scheduled_items.end());
+}
+
+}  // namespace
+
+Component::~Component() {
+  for (auto &item : scheduled_items) {
+    if (item->component == this)
+      item->removed = true;
+  }
+}
+
+float Component::get_setup_priority() const { return setup_priority::DATA; }
+
+void Component::call_setup() { this->setup(); }
+
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  add_item(this, name, false, timeout, std::move(f));
+}
+
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+  add_item(this, "", false, timeout, std::move(f));
+}
+
+bool Component::cancel_timeout(const std::string &name) { return cancel_item(this, name, false); }
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  add_item(this, name, true, interval, std::move(f));
+}
+
+void Component::set_interval(uint32_t interval, std::function<void()> &&f) {
+  add_item(this, "", true, interval, std::move(f));
+}
+
+bool Component::cancel_interval(const std::string &name) { return cancel_item(this, name, true); }
+
+void Component::defer(std::function<void()> &&f) { add_item(this, "", false, 0, std::move(f)); }
+
+void PollingComponent::call_setup() {
+  this->setup();
+  if (!this->is_failed())
+    this->start_poller();
+}
+
+void PollingComponent::start_poller() {
+  this->set_interval("update", this->get_update_interval(), [this]() { this->update(); });
+}
+
+void PollingComponent::stop_poller() { this->cancel_interval("update"); }
+
+namespace test {
+
+// ========== Main loop ==========
+
+uint64_t now_us() { return clock_us; }
+void advance_us(uint64_t us) { clock_us += us; }
+
+void set_loop_time(uint32_t normal_us, uint32_t high_frequency_us) {
+  loop_time_normal_us = normal_us;
+  loop_time_high_frequency_us = high_frequency_us;
+}
+
+void setup(std::initializer_list<Component *> components) {
+  std::vector<Component *> sorted(components);
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Component *a, const Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (auto *component : sorted)
+    component->call_setup();
+}
+
+void loop(std::initializer_list<Component *> components) {
+  for (auto *component : components) {
+    if (!component->is_failed())
+      component->loop();
+  }
+  run_scheduler();
+}
+
+void run_for(uint32_t ms, std::initializer_list<Component *> components) {
+  const uint64_t end = clock_us + uint64_t(ms) * 1000;
+  while (clock_us < end) {
+    loop(components);
+    clock_us += HighFrequencyLoopRequester::is_high_frequency() ? loop_time_high_frequency_us : loop_time_normal_us;
+  }
+}
+
+size_t scheduled(const Component *component) {
+  return std::count_if(scheduled_items.begin(), scheduled_items.end(), [component](const std::unique_ptr<ScheduledItem> &item) {
+    return !item->removed && item->component == component;
+  });
+}
+
+std::map<uint32_t, std::vector<uint8_t>> &preference_store() {
+  static std::map<uint32_t, std::vector<uint8_t>> store;
+  return store;
+}
+
+void log_printf(char level, const char *tag, const char *format, ...) {
+  static const bool verbose = getenv("ESPHOME_TEST_VERBOSE") != nullptr;
+  if (!verbose)
+    return;
+  va_list args;
+  va_start(args, format);
+  printf("[%c][%s] ", level, tag);
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+}
+
+// ========== I2C ==========
+
+bool RegisterDeviceEmulator::on_write(const uint8_t *data, size_t len) {
+  if (len == 0)
+    return true;
+  this->pointer_ = data[0];
+  for (size_t i = 1; i < len; i++)
+    this->write_register_(this->pointer_++, data[i]);
+  return true;
+}
+
+bool RegisterDeviceEmulator::on_read(uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    data[i] = this->read_register_(this->pointer_++);
+  return true;
+}
+
+std::vector<I2CDeviceEmulator *> I2CBusEmulator::find_(uint8_t address) const {
+  std::vector<I2CDeviceEmulator *> found;
+  for (auto *device : this->devices_) {
+    if (device->get_address() == address && device->is_present())
+      found.push_back(device);
+  }
+  return found;
+}
+
+bool I2CBusEmulator::start_(size_t len) {
+  if (!this->continued_)
+    this->stats_.transactions++;
+  this->stats_.transfers++;
+  this->continued_ = false;
+  if (this->failing_ || this->fail_count_ > 0) {
+    if (this->fail_count_ > 0)
+      this->fail_count_--;
+    this->stats_.nacks++;
+    this->stats_.bytes++;
+    return false;
+  }
+  this->stats_.bytes += 1 + len;
+  return true;
+}
+
+i2c::ErrorCode I2CBusEmulator::read(uint8_t address, uint8_t *data, size_t len) {
+  if (!this->start_(len))
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  auto devices = this->find_(address);
+  if (devices.empty()) {
+    this->stats_.nacks++;
+    this->stats_.bytes -= len;
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  if (devices.size() > 1)
+    this->stats_.conflicts++;
+  memset(data, 0xFF, len);
+  std::vector<uint8_t> buf(len);
+  bool ack = false;
+  for (auto *device : devices) {
+    if (!device->on_read(buf.data(), len))
+      continue;
+    ack = true;
+    for (size_t i = 0; i < len; i++)
+      data[i] &= buf[i];
+  }
+  if (!ack) {
+    this->stats_.nacks++;
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  return i2c::ERROR_OK;
+}
+
+i2c::ErrorCode I2CBusEmulator::write(uint8_t address, const uint8_t *data, size_t len, bool stop) {
+  if (!this->start_(len))
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  auto devices = this->find_(address);
+  if (devices.empty()) {
+    this->stats_.nacks++;
+    this->stats_.bytes -= len;
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  if (devices.size() > 1)
+    this->stats_.conflicts++;
+  bool ack = false;
+  for (auto *device : devices)
+    ack |= device->on_write(data, len);
+  if (!ack) {
+    this->stats_.nacks++;
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  this->continued_ = !stop;
+  return i2c::ERROR_OK;
+}
+
+// ========== Test runner ==========
+
+namespace {
+
+struct TestEntry {
+  const char *name;
+  TestFunction function;
+};
+
+std::vector<TestEntry> &tests() {
+  static std::vector<TestEntry> entries;
+  return entries;
+}
+
+int failures = 0;  // NOLINT
+
+}  // namespace
+
+TestRegistrar::TestRegistrar(const char *name, TestFunction function) { tests().push_back(TestEntry{name, function}); }
+
+void report_failure(const char *file, int line, const std::string &message) {
+  failures++;
+  printf("    %s:%d: expected %s\n", file, line, message.c_str());
+}
+
+}  // namespace test
+}  // namespace esphome
+
+void delay(uint32_t ms) { esphome::delay(ms); }
+void delayMicroseconds(uint32_t us) { esphome::delayMicroseconds(us); }
+
+// Usage: <test binary> [name filter]
+int main(int argc, char **argv) {
+  using namespace esphome::test;
+  const char *filter = argc > 1 ? argv[1] : nullptr;
+  int passed = 0;
+  int failed = 0;
+  for (const auto &entry : tests()) {
+    if (filter != nullptr && strstr(entry.name, filter) == nullptr)
+      continue;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+      entry.function();
+      fflush(stdout);
+      _exit(failures == 0 ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!ok && WIFSIGNALED(status))
+      printf("    crashed with signal %d\n", WTERMSIG(status));
+    printf("%s %s\n", ok ? "PASS" : "FAIL", entry.name);
+    (ok ? passed : failed)++;
+  }
+  printf("%d passed, %d failed\n", passed, failed);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+// Host test harness: a minimal test runner, an emulated clock and main loop, fake GPIO pins and an
+// emulated I2C bus the chip emulators in tests/emulators/ attach to.
+//
+// Every test case runs in its own process, so the static state of the components (the SI1145
+// sensor list, RTC memory) starts fresh. See tests/run_tests.sh for the build.
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace test {
+
+// ========== Test runner ==========
+
+using TestFunction = void (*)();
+
+struct TestRegistrar {
+  TestRegistrar(const char *name, TestFunction function);
+};
+
+void report_failure(const char *file, int line, const std::string &message);
+
+template<typename T> std::string to_string_(const T &value) {
+  std::ostringstream out;
+  // promote (u)int8_t so it prints as a number
+  if constexpr (std::is_arithmetic<T>::value) {
+    out << +value;
+  } else {
+    out << value;
+  }
+  return out.str();
+}
+
+template<typename A, typename B>
+void expect_eq(const A &a, const B &b, const char *a_text, const char *b_text, const char *file, int line) {
+  if (a == b)
+    return;
+  report_failure(file, line,
+                 std::string(a_text) + " == " + b_text + " (" + to_string_(a) + " != " + to_string_(b) + ")");
+}
+
+inline void expect_near(double a, double b, double tolerance, const char *a_text, const char *b_text, const char *file,
+                        int line) {
+  if (std::fabs(a - b) <= tolerance)
+    return;
+  report_failure(file, line,
+                 std::string(a_text) + " ~= " + b_text + " (" + to_string_(a) + " vs " + to_string_(b) + ")");
+}
+
+#define TEST_CASE(name) \
+  static void name(); \
+  static ::esphome::test::TestRegistrar name##_registrar(#name, name); \
+  static void name()
+
+#define EXPECT(cond) \
+  do { \
+    if (!(cond)) \
+      ::esphome::test::report_failure(__FILE__, __LINE__, #cond); \
+  } while (0)
+#define EXPECT_EQ(a, b) ::esphome::test::expect_eq((a), (b), #a, #b, __FILE__, __LINE__)
+#define EXPECT_NEAR(a, b, tolerance) ::esphome::test::expect_near((a), (b), (tolerance), #a, #b, __FILE__, __LINE__)
+
+// ========== Clock and main loop ==========
+
+uint64_t now_us();
+void advance_us(uint64_t us);
+inline void advance_ms(uint32_t ms) { advance_us(uint64_t(ms) * 1000); }
+
+/// Time a loop iteration takes on top of what the components spend in delay(): the 16ms pause of
+/// the main loop, or the high frequency loop time while a HighFrequencyLoopRequester is active.
+void set_loop_time(uint32_t normal_us, uint32_t high_frequency_us);
+
+/// Run call_setup() of the components, highest setup priority first.
+void setup(std::initializer_list<Component *> components);
+/// One main loop iteration: loop() of every component that isn't failed, then the due timeouts,
+/// intervals and deferred calls. The clock isn't advanced.
+void loop(std::initializer_list<Component *> components);
+/// Loop for ms of emulated time, advancing the clock by the loop time after every iteration.
+void run_for(uint32_t ms, std::initializer_list<Component *> components);
+/// Number of scheduled timeouts and intervals of a component.
+size_t scheduled(const Component *component);
+
+// ========== GPIO ==========
+
+class FakePin : public GPIOPin {
+ public:
+  struct Write {
+    uint64_t time_us;
+    bool value;
+  };
+
+  void setup() override { this->setup_done = true; }
+  void pin_mode(gpio::Flags flags) override { this->mode = flags; }
+  bool digital_read() override { return this->on_read ? this->on_read() : this->value; }
+  void digital_write(bool value) override {
+    this->value = value;
+    this->writes.push_back(Write{now_us(), value});
+    if (this->on_write)
+      this->on_write(value);
+  }
+  std::string dump_summary() const override { return "fake pin"; }
+
+  bool setup_done{false};
+  bool value{false};
+  gpio::Flags mode{gpio::FLAG_NONE};
+  std::vector<Write> writes;
+  /// Called on every write, used by the emulators to follow enable and LDAC lines.
+  std::function<void(bool)> on_write;
+  std::function<bool()> on_read;
+};
+
+// ========== I2C ==========
+
+/// A device on the emulated bus. Transfers return false to NACK.
+class I2CDeviceEmulator {
+ public:
+  explicit I2CDeviceEmulator(uint8_t address) : address_(address) {}
+  virtual ~I2CDeviceEmulator() = default;
+
+  uint8_t get_address() const { return this->address_; }
+  /// A device that isn't powered doesn't acknowledge its address.
+  virtual bool is_present() const { return true; }
+  virtual bool on_write(const uint8_t *data, size_t len) = 0;
+  virtual bool on_read(uint8_t *data, size_t len) = 0;
+
+ protected:
+  uint8_t address_;
+};
+
+/// Register file with an auto-incremented register pointer, set by the first byte of a write.
+class RegisterDeviceEmulator : public I2CDeviceEmulator {
+ public:
+  using I2CDeviceEmulator::I2CDeviceEmulator;
+
+  bool on_write(const uint8_t *data, size_t len) override;
+  bool on_read(uint8_t *data, size_t len) override;
+
+ protected:
+  virtual uint8_t read_register_(uint8_t reg) = 0;
+  virtual void write_register_(uint8_t reg, uint8_t value) = 0;
+
+  uint8_t pointer_{0};
+};
+
+/// Emulated bus. Counts traffic like the bus cost model of the README: one address byte per
+/// transfer, and a register write followed by a read without a stop (repeated start) is one
+/// transaction. Devices answering the same address are wired-AND, like on a real bus.
+class I2CBusEmulator : public i2c::I2CBus {
+ public:
+  struct Stats {
+    uint32_t transactions;
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t nacks;
+    // transfers answered by more than one device
+    uint32_t conflicts;
+  };
+
+  void add_device(I2CDeviceEmulator *device) { this->devices_.push_back(device); }
+  i2c::ErrorCode read(uint8_t address, uint8_t *data, size_t len) override;
+  i2c::ErrorCode write(uint8_t address, const uint8_t *data, size_t len, bool stop) override;
+
+  /// NACK the next count transfers, whatever their address.
+  void fail_next(uint32_t count) { this->fail_count_ = count; }
+  /// NACK every transfer until cleared, like a disconnected bus.
+  void set_failing(bool failing) { this->failing_ = failing; }
+
+  const Stats &stats() const { return this->stats_; }
+  void reset_stats() { this->stats_ = Stats{}; }
+  /// Time the bytes counted so far take on the wire, 9 clocks per byte.
+  static double bus_time_us(uint32_t bytes, uint32_t frequency) { return bytes * 9 * 1e6 / frequency; }
+
+ protected:
+  std::vector<I2CDeviceEmulator *> find_(uint8_t address) const;
+  bool start_(size_t len);
+
+  std::vector<I2CDeviceEmulator *> devices_;
+  Stats stats_{};
+  bool continued_{false};
+  uint32_t fail_count_{0};
+  bool failing_{false};
+};
+
+}  // namespace test
+}  // namespace esphome
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Build and run the host tests: the components are compiled against the ESPHome stand-ins of
+# tests/harness and talk to the chip emulators of tests/emulators.
+#
+#   tests/run_tests.sh [test name filter]
+#
+# CXX selects the compiler (g++ by default), BUILD_DIR the build directory (_host_build).
+# ESPHOME_TEST_VERBOSE=1 prints the component logs, ESPHOME_UPDATE_BUS_COST=1 regenerates the bus
+# cost table of README.md (test_bus_cost fails when its bus columns are stale).
+set -e
+cd "$(dirname "$0")/.."
+BUILD=${BUILD_DIR:-_host_build}
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++17 -O1 -g -Wall -Wno-unused-function -Wno-unused-variable -Werror=format"
+
+# the components include each other as esphome/components/<name>/
+mkdir -p "$BUILD/include/esphome/components"
+for d in components/*/; do
+  ln -sfn "$PWD/$d" "$BUILD/include/esphome/components/$(basename "$d")"
+done
+INCLUDES="-Itests/harness -Itests/emulators -I$BUILD/include"
+
+TESTS=""
+build() {
+  name=$1
+  shift
+  echo "Building $name"
+  $CXX $CXXFLAGS $INCLUDES -o "$BUILD/$name" tests/harness/harness.cpp "$@"
+  TESTS="$TESTS $name"
+}
+
+BUS="components/bus_stats/bus_stats.cpp components/bus_scheduler/bus_scheduler.cpp"
+build test_calc tests/test_calc.cpp
+build test_bus_scheduler tests/test_bus_scheduler.cpp components/bus_scheduler/bus_scheduler.cpp
+build test_mcp4728 tests/test_mcp4728.cpp components/mcp4728/mcp4728_output.cpp components/mcp4728/mcp4728_light.cpp $BUS
+build test_si1145 tests/test_si1145.cpp components/si1145/si1145.cpp $BUS
+build test_max44009 tests/test_max44009.cpp components/max44009/max44009.cpp $BUS
+build test_uartpin tests/test_uartpin.cpp components/uartpin/uartpin.cpp
+build test_daylight_controller tests/test_daylight_controller.cpp components/daylight_controller/daylight_controller.cpp \
+  components/mcp4728/mcp4728_output.cpp $BUS
+build test_bus_cost tests/test_bus_cost.cpp components/si1145/si1145.cpp components/max44009/max44009.cpp \
+  components/mcp4728/mcp4728_output.cpp $BUS
+
+# the replay tool shares the calc headers, make sure it still builds
+$CXX -std=c++11 -O2 -Wall -Icomponents -o "$BUILD/trace_replay" tools/trace_replay.cpp
+
+status=0
+for t in $TESTS; do
+  echo "== $t"
+  "$BUILD/$t" "$@" || status=1
+done
+exit $status
@@ -0,0 +1,306 @@
+// Bus cost of the hot paths, measured on the emulated bus, and their host CPU time. The "I2C bus
+// cost" table of README.md is generated from these measurements: the test fails when the bus
+// columns of the table are stale (CPU time varies from run to run and host to host, so it isn't
+// compared), and ESPHOME_UPDATE_BUS_COST=1 tests/run_tests.sh bus_cost rewrites it.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "harness.h"
+#include "max44009_emulator.h"
+#include "mcp4728_emulator.h"
+#include "si1145_emulator.h"
+#include "esphome/components/max44009/max44009.h"
+#include "esphome/components/mcp4728/mcp4728_output.h"
+#include "esphome/components/si1145/si1145.h"
+
+using namespace esphome;
+
+namespace {
+
+const char *const README = "README.md";
+const char *const TABLE_BEGIN = "<!-- bus-cost-table begin: generated by tests/test_bus_cost.cpp -->\n";
+const char *const TABLE_END = "<!-- bus-cost-table end -->\n";
+// column of the host CPU time, counted from the leading '|'
+const size_t CPU_COLUMN = 3;
+// calls the CPU time is averaged over
+const int CPU_RUNS = 10000;
+
+/// Bus traffic of one call and host CPU time per call.
+struct Cost {
+  test::I2CBusEmulator::Stats stats;
+  double cpu_us;
+};
+
+double cpu_time_us() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+double cpu_total_us(const std::function<void()> &prepare, const std::function<void()> &call) {
+  double total = 0;
+  for (int i = 0; i < CPU_RUNS; i++) {
+    prepare();
+    const double start = cpu_time_us();
+    call();
+    total += cpu_time_us() - start;
+  }
+  return total;
+}
+
+/// Average CPU time of call() over CPU_RUNS calls, each after an untimed prepare(), without the
+/// cost of reading the clock around it.
+double cpu_us(const std::function<void()> &prepare, const std::function<void()> &call) {
+  static const double overhead = cpu_total_us([]() {}, []() {});
+  const double total = cpu_total_us(prepare, call) - overhead;
+  return total > 0 ? total / CPU_RUNS : 0;
+}
+
+std::string format_ms(uint32_t bytes, uint32_t frequency) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%.1fms", test::I2CBusEmulator::bus_time_us(bytes, frequency) / 1000.0);
+  return buf;
+}
+
+std::string row(const char *call, const char *configuration, const Cost &cost, const char *notes) {
+  char cpu[16];
+  snprintf(cpu, sizeof(cpu), "%.2fus", cost.cpu_us);
+  std::ostringstream out;
+  out << "| `" << call << "` | " << configuration << " | " << cpu << " | " << cost.stats.transactions << " | "
+      << cost.stats.bytes << " | " << format_ms(cost.stats.bytes, 100000) << " | "
+      << format_ms(cost.stats.bytes, 400000) << " | " << notes << " |\n";
+  return out.str();
+}
+
+/// The table with the CPU time cells emptied, for comparison.
+std::string without_cpu(const std::string &table) {
+  std::istringstream in(table);
+  std::string out;
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t begin = 0;
+    for (size_t column = 0; column < CPU_COLUMN && begin != std::string::npos; column++)
+      begin = line.find('|', begin + (column > 0 ? 1 : 0));
+    const size_t end = begin == std::string::npos ? begin : line.find('|', begin + 1);
+    if (end != std::string::npos)
+      line.erase(begin + 1, end - begin - 1);
+    out += line + "\n";
+  }
+  return out;
+}
+
+// ========== SI1145 ==========
+
+// write_param_() is what an auto range step costs, per parameter written
+class SI1145Probe : public si1145::SI1145Component {
+ public:
+  using si1145::SI1145Component::write_param_;
+};
+
+struct SI1145Bench {
+  SI1145Bench() {
+    this->bus.add_device(&this->chip);
+    this->si.set_i2c_bus(&this->bus);
+    this->si.set_i2c_address(0x60);
+    this->si.set_update_interval(1000);
+    // the YAML defaults: auto range starting at high range, gain 0
+    this->si.set_visible_range(si1145::RANGE_HIGH);
+    this->si.set_infrared_range(si1145::RANGE_HIGH);
+    this->chip.set_light(1000, 200);
+    this->chip.set_uv_index(3.5f);
+  }
+
+  /// One update() once auto range has settled on a steady light.
+  Cost update() {
+    test::setup({&this->si});
+    for (int i = 0; i < 10; i++) {
+      test::advance_ms(1000);
+      this->si.update();
+    }
+    test::advance_ms(1000);
+    this->bus.reset_stats();
+    this->si.update();
+    Cost cost{this->bus.stats(), 0};
+    cost.cpu_us = cpu_us([]() { test::advance_ms(1000); }, [this]() { this->si.update(); });
+    return cost;
+  }
+
+  test::I2CBusEmulator bus;
+  test::SI1145Emulator chip;
+  SI1145Probe si;
+  sensor::Sensor visible, infrared, uvindex, illuminance;
+};
+
+Cost si1145_update(const std::function<void(SI1145Bench &)> &configure) {
+  SI1145Bench b;
+  configure(b);
+  return b.update();
+}
+
+Cost si1145_param() {
+  SI1145Bench b;
+  test::setup({&b.si});
+  b.bus.reset_stats();
+  b.si.write_param_(0x11, 0);
+  Cost cost{b.bus.stats(), 0};
+  cost.cpu_us = cpu_us([]() {}, [&b]() { b.si.write_param_(0x11, 0); });
+  return cost;
+}
+
+// ========== MAX44009 ==========
+
+Cost max44009_update() {
+  test::I2CBusEmulator bus;
+  test::MAX44009Emulator chip;
+  max44009::MAX44009Sensor sensor;
+  bus.add_device(&chip);
+  sensor.set_i2c_bus(&bus);
+  sensor.set_i2c_address(0x4A);
+  chip.set_lux(250);
+  test::setup({&sensor});
+  bus.reset_stats();
+  sensor.update();
+  Cost cost{bus.stats(), 0};
+  cost.cpu_us = cpu_us([]() {}, [&sensor]() { sensor.update(); });
+  return cost;
+}
+
+// ========== MCP4728 ==========
+
+struct MCP4728Bench {
+  explicit MCP4728Bench(bool eeprom, bool ldac_tied_low = false)
+      : dac(eeprom), eeprom(eeprom), ldac_tied_low(ldac_tied_low) {
+    this->bus.add_device(&this->chip);
+    this->dac.set_i2c_bus(&this->bus);
+    this->dac.set_i2c_address(0x60);
+    this->dac.set_ldac_tied_low(ldac_tied_low);
+    for (uint8_t i = 0; i < 4; i++)
+      this->channels[i] = this->dac.create_channel((mcp4728::MCP4728_CHANNEL) i, mcp4728::MCP4728_VREF_VDD,
+                                                   mcp4728::MCP4728_GAIN_X1);
+  }
+
+  Cost setup() {
+    test::setup({&this->dac});
+    Cost cost{this->bus.stats(), 0};
+    // a fresh chip and component each time, as at boot
+    std::unique_ptr<MCP4728Bench> bench;
+    cost.cpu_us = cpu_us([this, &bench]() { bench.reset(new MCP4728Bench(this->eeprom, this->ldac_tied_low)); },
+                         [&bench]() { bench->dac.setup(); });
+    return cost;
+  }
+
+  /// One loop() after the levels of channels first..first+count-1 changed.
+  Cost loop(uint8_t first, uint8_t count) {
+    test::setup({&this->dac});
+    test::loop({&this->dac});
+    this->bus.reset_stats();
+    for (uint8_t i = first; i < first + count; i++)
+      this->channels[i]->set_level(0.5f);
+    test::loop({&this->dac});
+    Cost cost{this->bus.stats(), 0};
+    // alternate the levels so every timed loop() has the same writes to do
+    float level = 0.5f;
+    cost.cpu_us = cpu_us(
+        [this, first, count, &level]() {
+          level = level == 0.5f ? 0.25f : 0.5f;
+          for (uint8_t i = first; i < first + count; i++)
+            this->channels[i]->set_level(level);
+        },
+        [this]() { this->dac.loop(); });
+    return cost;
+  }
+
+  test::I2CBusEmulator bus;
+  test::MCP4728Emulator chip;
+  mcp4728::MCP4728Output dac;
+  mcp4728::MCP4728Channel *channels[4];
+  bool eeprom;
+  bool ldac_tied_low;
+};
+
+std::string generate_table() {
+  std::string table;
+  table += "| Call | Configuration | Host CPU/call | Transactions | Bytes | Bus time @100kHz | Bus time @400kHz | Notes "
+           "|\n";
+  table += "|------|---------------|---------------|--------------|-------|------------------|------------------|-------"
+           "|\n";
+  table += row("SI1145Component::update()", "`visible`, `infrared`, `uv_index` and `calculated_lux`",
+               si1145_update([](SI1145Bench &b) {
+                 b.si.set_visible_sensor(&b.visible);
+                 b.si.set_infrared_sensor(&b.infrared);
+                 b.si.set_uvindex_sensor(&b.uvindex);
+                 b.si.set_illuminance_sensor(&b.illuminance);
+               }),
+               "Plus a 20ms conversion wait, blocking unless a `bus_scheduler` is used.");
+  table += row("SI1145Component::update()", "`visible` and `infrared`", si1145_update([](SI1145Bench &b) {
+                 b.si.set_visible_sensor(&b.visible);
+                 b.si.set_infrared_sensor(&b.infrared);
+               }),
+               "");
+  table += row("SI1145Component::update()", "`visible` only", si1145_update([](SI1145Bench &b) {
+                 b.si.set_visible_sensor(&b.visible);
+               }),
+               "");
+  table += row("SI1145Component::update()", "all outputs, `temp_correction` on `visible`",
+               si1145_update([](SI1145Bench &b) {
+                 b.si.set_visible_sensor(&b.visible);
+                 b.si.set_infrared_sensor(&b.infrared);
+                 b.si.set_uvindex_sensor(&b.uvindex);
+                 b.si.set_illuminance_sensor(&b.illuminance);
+                 b.si.set_visible_temp_correction(true);
+               }),
+               "");
+  table += row("SI1145Component::update()", "auto range step, per parameter written", si1145_param(),
+               "On top of the update. A step writes the range, the gain or both, on each channel.");
+  table += row("MAX44009Sensor::update()", "any", max44009_update(), "");
+  table += row("MCP4728Output::setup()", "any", MCP4728Bench(false).setup(), "Register readback, once at boot.");
+  table += row("MCP4728Output::loop()", "MultiWrite, 1 channel changed", MCP4728Bench(false).loop(0, 1),
+               "Only when a channel changed.");
+  table += row("MCP4728Output::loop()", "MultiWrite, 2 channels changed", MCP4728Bench(false).loop(0, 2), "");
+  table += row("MCP4728Output::loop()", "Fast Write, 4 channels changed", MCP4728Bench(false, true).loop(0, 4),
+               "Used instead of MultiWrite when 3 or 4 channels change level only, with `ldac_pin`, `sync_with` or "
+               "`ldac_tied_low`. Always carries all 4.");
+  table += row("MCP4728Output::loop()", "SequentialWrite, channel A changed", MCP4728Bench(true).loop(0, 1),
+               "Runs from the first changed channel up to channel D. Plus up to 50ms of EEPROM write time on the "
+               "chip.");
+  table += row("MCP4728Output::loop()", "SequentialWrite, channel D changed", MCP4728Bench(true).loop(3, 1), "");
+  return table;
+}
+
+}  // namespace
+
+TEST_CASE(readme_bus_cost_table_is_current) {
+  std::ifstream in(README);
+  EXPECT(in.good());
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string readme = buffer.str();
+  const size_t begin = readme.find(TABLE_BEGIN);
+  const size_t end = readme.find(TABLE_END);
+  EXPECT(begin != std::string::npos && end != std::string::npos && begin < end);
+  if (begin == std::string::npos || end == std::string::npos || end < begin)
+    return;
+  const size_t start = begin + strlen(TABLE_BEGIN);
+  const std::string table = generate_table();
+  // the measurements are the benchmark report, printed on every run
+  printf("    measured:\n%s", table.c_str());
+  const char *update = getenv("ESPHOME_UPDATE_BUS_COST");
+  if (update != nullptr && strcmp(update, "1") == 0) {
+    readme.replace(start, end - start, table);
+    std::ofstream(README) << readme;
+    printf("    %s updated\n", README);
+    return;
+  }
+  const bool current = without_cpu(readme.substr(start, end - start)) == without_cpu(table);
+  EXPECT(current);
+  if (!current)
+    printf("    run ESPHOME_UPDATE_BUS_COST=1 tests/run_tests.sh bus_cost to update %s\n", README);
+}
@@ -0,0 +1,91 @@
+// Priorities, interleaving and step timing of the bus scheduler.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+
+using namespace esphome;
+using namespace esphome::bus_scheduler;
+
+TEST_CASE(actuators_run_before_sensors) {
+  BusScheduler sched;
+  std::string order;
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    order += "s";
+    return BUS_JOB_DONE;
+  });
+  sched.submit(BUS_PRIORITY_ACTUATOR, [&]() -> uint32_t {
+    order += "a";
+    return BUS_JOB_DONE;
+  });
+  test::loop({&sched});
+  EXPECT_EQ(order, std::string("as"));
+}
+
+TEST_CASE(sensor_steps_are_interleaved) {
+  BusScheduler sched;
+  std::string order;
+  for (char name : {'x', 'y'}) {
+    auto step = std::make_shared<int>(0);
+    sched.submit(BUS_PRIORITY_SENSOR, [&order, name, step]() -> uint32_t {
+      order += name;
+      return ++*step == 3 ? BUS_JOB_DONE : 0;
+    });
+  }
+  // one sensor step per loop by default, jobs take turns
+  for (int i = 0; i < 6; i++)
+    test::loop({&sched});
+  EXPECT_EQ(order, std::string("xyxyxy"));
+}
+
+TEST_CASE(sensor_slice_bounds_steps_per_loop) {
+  BusScheduler sched;
+  sched.set_sensor_slice(2);
+  int steps = 0;
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    steps++;
+    return 0;
+  });
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    steps++;
+    return 0;
+  });
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    steps++;
+    return 0;
+  });
+  test::loop({&sched});
+  EXPECT_EQ(steps, 2);
+}
+
+TEST_CASE(step_wait_is_honoured) {
+  BusScheduler sched;
+  std::vector<uint32_t> times;
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    times.push_back(millis());
+    return times.size() == 2 ? BUS_JOB_DONE : 20;
+  });
+  test::set_loop_time(1000, 1000);
+  test::run_for(50, {&sched});
+  EXPECT_EQ(times.size(), 2u);
+  EXPECT_EQ(times[1] - times[0], 20u);
+}
+
+TEST_CASE(actuator_submitted_by_a_sensor_step_runs_next_loop) {
+  BusScheduler sched;
+  std::string order;
+  sched.submit(BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    order += "s";
+    sched.submit(BUS_PRIORITY_ACTUATOR, [&]() -> uint32_t {
+      order += "a";
+      return BUS_JOB_DONE;
+    });
+    return BUS_JOB_DONE;
+  });
+  test::loop({&sched});
+  test::loop({&sched});
+  EXPECT_EQ(order, std::string("sa"));
+}
@@ -0,0 +1,179 @@
+// Conversion, auto range and flicker math of si1145_calc.h and max44009_calc.h.
+
+#include <cmath>
+#include <vector>
+
+#include "harness.h"
+#include "max44009_emulator.h"
+#include "esphome/components/max44009/max44009_calc.h"
+#include "esphome/components/si1145/si1145_calc.h"
+
+using namespace esphome;
+using namespace esphome::si1145;
+
+TEST_CASE(max44009_convert_to_lux) {
+  // exponent 0: 0.045 lx per count
+  EXPECT_EQ(max44009::convert_to_lux(0x00, 0x00), 0);
+  EXPECT_EQ(max44009::convert_to_lux(0x01, 0x06), 1);
+  // 0xFF mantissa at exponent 14, the top of the range
+  EXPECT_EQ(max44009::convert_to_lux(0xEF, 0x0F), 188006);
+  // the emulator encoding reads back within one mantissa step
+  for (float lux : {3.0f, 150.0f, 2500.0f, 60000.0f}) {
+    uint8_t high, low;
+    test::MAX44009Emulator::encode(lux, &high, &low);
+    EXPECT_NEAR(max44009::convert_to_lux(high, low), lux, lux / 128 + 1);
+  }
+}
+
+TEST_CASE(max44009_lux_change_rate) {
+  // 10% in 30s
+  EXPECT_NEAR(max44009::lux_change_rate(1000, 1100, 30000, 2), 0.2f, 1e-4);
+  // 0 <-> 1 lx is within the deadband
+  EXPECT_EQ(max44009::lux_change_rate(0, 1, 1000, 2), 0.0f);
+  EXPECT_EQ(max44009::lux_change_rate(1, 0, 1000, 2), 0.0f);
+  // past the deadband, the relative change is taken from 1 lx at least
+  EXPECT_NEAR(max44009::lux_change_rate(0, 3, 60000, 2), 3.0f, 1e-4);
+  // without a deadband, any change counts
+  EXPECT_NEAR(max44009::lux_change_rate(0, 1, 60000, 0), 1.0f, 1e-4);
+  // one count at exponent 11
+  EXPECT_NEAR(max44009::lux_step(11), 92.16f, 1e-3);
+}
+
+TEST_CASE(si1145_range_and_gain) {
+  EXPECT_NEAR(apply_range_and_gain(1000, RANGE_LOW, 0), 1000, 1e-3);
+  EXPECT_NEAR(apply_range_and_gain(1000, RANGE_LOW, 3), 125, 1e-3);
+  EXPECT_NEAR(apply_range_and_gain(1000, RANGE_HIGH, 0), 14500, 1e-3);
+  // IR light is subtracted, the result never goes negative
+  EXPECT_NEAR(illumination_combine_sensors(100, RANGE_LOW, 0, 100, RANGE_LOW, 0), 533, 1e-2);
+  EXPECT_EQ(illumination_combine_sensors(0, RANGE_LOW, 0, 1000, RANGE_LOW, 0), 0.0f);
+}
+
+TEST_CASE(si1145_temp_correction) {
+  // no correction at the start temperature, nor in high range
+  EXPECT_NEAR(visible_temp_correction(1000, RANGE_LOW, 0, 500, 500), 1000, 1e-3);
+  EXPECT_NEAR(visible_temp_correction(1000, RANGE_HIGH, 0, 850, 500), 1000, 1e-3);
+  EXPECT_NEAR(visible_temp_correction(1000, RANGE_LOW, 0, 850, 500), 997, 1e-3);
+  EXPECT_NEAR(infrared_temp_correction(1000, RANGE_LOW, 1, 850, 500), 999.4, 1e-3);
+}
+
+TEST_CASE(si1145_auto_range_visible) {
+  Range range = RANGE_LOW;
+  uint8_t gain = 2;
+  // too bright: gain goes down first, then the range goes up
+  EXPECT_EQ(auto_range_visible(30000, range, gain), AUTO_RANGE_GAIN_CHANGED);
+  EXPECT_EQ(gain, 1);
+  auto_range_visible(30000, range, gain);
+  EXPECT_EQ(auto_range_visible(30000, range, gain), AUTO_RANGE_RANGE_CHANGED);
+  EXPECT_EQ(range, RANGE_HIGH);
+  EXPECT_EQ(auto_range_visible(30000, range, gain), 0);
+  // in the window nothing moves
+  EXPECT_EQ(auto_range_visible(5000, range, gain), 0);
+  // too dark: gain goes up to 7, then back to low range at gain 0
+  for (int i = 0; i < 7; i++)
+    EXPECT_EQ(auto_range_visible(100, range, gain), AUTO_RANGE_GAIN_CHANGED);
+  EXPECT_EQ(gain, 7);
+  EXPECT_EQ(auto_range_visible(100, range, gain), AUTO_RANGE_RANGE_CHANGED | AUTO_RANGE_GAIN_CHANGED);
+  EXPECT_EQ(range, RANGE_LOW);
+  EXPECT_EQ(gain, 0);
+}
+
+TEST_CASE(si1145_auto_range_infrared_saturated) {
+  Range range = RANGE_HIGH;
+  uint8_t gain = 3;
+  EXPECT_EQ(auto_range_infrared(65500, range, gain), AUTO_RANGE_RANGE_CHANGED | AUTO_RANGE_GAIN_CHANGED);
+  EXPECT_EQ(range, RANGE_LOW);
+  EXPECT_EQ(gain, 0);
+}
+
+static std::vector<uint16_t> sine(float frequency, float mean, float amplitude, size_t count, uint32_t period_us) {
+  std::vector<uint16_t> samples(count);
+  for (size_t i = 0; i < count; i++)
+    samples[i] = mean + amplitude * std::sin(2 * M_PI * frequency * i * period_us / 1e6);
+  return samples;
+}
+
+static std::vector<uint32_t> times(size_t count, uint32_t period_us) {
+  std::vector<uint32_t> times_us(count);
+  for (size_t i = 0; i < count; i++)
+    times_us[i] = i * period_us;
+  return times_us;
+}
+
+TEST_CASE(si1145_flicker_sine) {
+  auto samples = sine(100, 1000, 400, 256, 1000);
+  auto times_us = times(256, 1000);
+  FlickerResult r = analyse_flicker(samples.data(), times_us.data(), samples.size());
+  // 10 samples per period peak at sin(72 deg): 100 * 0.951 * 400 / 1000 %
+  EXPECT_NEAR(r.percent_flicker, 380, 2);
+  // area above the mean, 400 * (0.588 + 0.951) * 2 / 10 / 1000 per sample
+  EXPECT_NEAR(r.flicker_index, 123, 2);
+  EXPECT_NEAR(r.frequency, 1000, 5);
+}
+
+TEST_CASE(si1145_flicker_steady) {
+  std::vector<uint16_t> samples(256, 1000);
+  samples[10] = 1001;
+  auto times_us = times(256, 1000);
+  FlickerResult r = analyse_flicker(samples.data(), times_us.data(), samples.size());
+  EXPECT_EQ(r.percent_flicker, 0);
+  EXPECT_EQ(r.frequency, 0);
+  // nothing to analyse
+  EXPECT_EQ(analyse_flicker(samples.data(), times_us.data(), 1).frequency, 0);
+}
+
+// deterministic noise in [-amplitude, amplitude]
+static std::vector<int> noise(size_t count, int amplitude) {
+  std::vector<int> values(count);
+  uint32_t state = 1;
+  for (size_t i = 0; i < count; i++) {
+    state = state * 1103515245 + 12345;
+    values[i] = static_cast<int>((state >> 16) % (2 * amplitude + 1)) - amplitude;
+  }
+  return values;
+}
+
+TEST_CASE(si1145_flicker_noisy_steady) {
+  // +-3 counts of noise on a steady light: below the minimum modulation depth
+  auto n = noise(256, 3);
+  std::vector<uint16_t> samples(256);
+  for (size_t i = 0; i < samples.size(); i++)
+    samples[i] = 2000 + n[i];
+  auto times_us = times(256, 1000);
+  FlickerResult r = analyse_flicker(samples.data(), times_us.data(), samples.size());
+  EXPECT_EQ(r.percent_flicker, 0);
+  EXPECT_EQ(r.flicker_index, 0);
+  EXPECT_EQ(r.frequency, 0);
+}
+
+TEST_CASE(si1145_flicker_dim_noisy) {
+  // +-4 counts of noise on a dim steady light reach the minimum modulation depth, and a
+  // (hi - lo) / 8 hysteresis alone would be 1 count: every noise swing would be a crossing
+  auto n = noise(256, 4);
+  std::vector<uint16_t> samples(256);
+  for (size_t i = 0; i < samples.size(); i++)
+    samples[i] = 300 + n[i];
+  auto times_us = times(256, 1000);
+  FlickerResult r = analyse_flicker(samples.data(), times_us.data(), samples.size());
+  EXPECT(r.percent_flicker >= FLICKER_MIN_PERCENT);
+  EXPECT_EQ(r.frequency, 0);
+
+  // a real 100 Hz modulation above the noise is still found
+  for (size_t i = 0; i < samples.size(); i++)
+    samples[i] = 300 + 20 * std::sin(2 * M_PI * 100 * i / 1000.0) + n[i];
+  EXPECT_NEAR(analyse_flicker(samples.data(), times_us.data(), samples.size()).frequency, 1000, 10);
+}
+
+TEST_CASE(si1145_flicker_uneven_spacing) {
+  // 100 Hz read at 1ms, with every 8th sample 1ms late: the timestamps keep the frequency right
+  std::vector<uint32_t> times_us(256);
+  std::vector<uint16_t> samples(256);
+  for (size_t i = 0; i < samples.size(); i++) {
+    times_us[i] = i * 1000 + (i / 8) * 1000;
+    samples[i] = 1000 + 400 * std::sin(2 * M_PI * 100 * times_us[i] / 1e6);
+  }
+  EXPECT_NEAR(analyse_flicker(samples.data(), times_us.data(), samples.size()).frequency, 1000, 10);
+  EXPECT_EQ(flicker_max_gap(times_us.data(), times_us.size()), 2000u);
+  // 2ms resolves 120 Hz, 16ms (a normal loop) not even 40 Hz
+  EXPECT(flicker_gap_resolves(2000, FLICKER_MIN_RESOLVED_FREQUENCY));
+  EXPECT(!flicker_gap_resolves(16000, 400));
+}
@@ -0,0 +1,98 @@
+// Daylight controller closing the loop through an emulated MCP4728 and a simple room model:
+// lux = daylight + 1000 lx at full output.
+
+#include <algorithm>
+
+#include "harness.h"
+#include "mcp4728_emulator.h"
+#include "esphome/components/daylight_controller/daylight_controller.h"
+
+using namespace esphome;
+using namespace esphome::daylight_controller;
+
+namespace {
+
+struct Fixture {
+  /// power_on_a: the DAC code channel A loads from its EEPROM at power-on
+  explicit Fixture(uint16_t power_on_a = 0) : dac(false) {
+    chip.set_eeprom(0, test::MCP4728Emulator::Channel{0, 0, 0, power_on_a});
+    chip.power_cycle();
+    bus.add_device(&chip);
+    dac.set_i2c_bus(&bus);
+    dac.set_i2c_address(0x60);
+    auto *channel = dac.create_channel(mcp4728::MCP4728_CHANNEL_A, mcp4728::MCP4728_VREF_VDD, mcp4728::MCP4728_GAIN_X1);
+    controller.set_sensor(&lux);
+    controller.add_output(channel);
+    controller.set_gains(0.0005f, 0.0005f);
+    test::setup({&dac, &controller});
+  }
+
+  float room_lux() const { return this->daylight + 1000.0f * this->chip.output(0).data / 4095.0f; }
+
+  /// One sensor sample per second for the given time, returns the highest lux seen.
+  float run(uint32_t seconds) {
+    float peak = 0;
+    for (uint32_t i = 0; i < seconds; i++) {
+      test::advance_ms(1000);
+      this->lux.publish_state(this->room_lux());
+      test::loop({&this->dac, &this->controller});
+      peak = std::max(peak, this->room_lux());
+    }
+    return peak;
+  }
+
+  float daylight{0};
+  test::I2CBusEmulator bus;
+  test::MCP4728Emulator chip;
+  mcp4728::MCP4728Output dac;
+  sensor::Sensor lux;
+  DaylightController controller;
+};
+
+}  // namespace
+
+TEST_CASE(holds_the_target) {
+  Fixture f;
+  f.daylight = 200;
+  f.controller.set_target(500);
+  f.run(120);
+  EXPECT_NEAR(f.room_lux(), 500, 5);
+  // daylight goes up, the lamp dims
+  f.daylight = 400;
+  f.run(120);
+  EXPECT_NEAR(f.room_lux(), 500, 5);
+  EXPECT_NEAR(f.controller.get_level(), 0.1f, 0.01f);
+}
+
+TEST_CASE(no_windup_while_slew_limited) {
+  Fixture f;
+  f.controller.set_max_slew(0.01f);
+  f.controller.set_target(100);
+  f.run(30);
+  // a big step: the ramp takes about a minute, the integral must not grow meanwhile
+  f.controller.set_target(800);
+  const float peak = f.run(240);
+  EXPECT(peak < 800 * 1.02f);
+  EXPECT_NEAR(f.room_lux(), 800, 10);
+}
+
+TEST_CASE(recovers_quickly_from_saturation) {
+  Fixture f;
+  f.controller.set_target(2000);
+  f.run(60);
+  EXPECT_NEAR(f.controller.get_level(), 1.0f, 1e-3);
+  // an unreachable target held for a minute doesn't delay the way back
+  f.controller.set_target(500);
+  f.run(20);
+  EXPECT_NEAR(f.room_lux(), 500, 25);
+}
+
+TEST_CASE(first_level_is_written_even_if_zero) {
+  // the lamp comes up at half power from its EEPROM, and daylight alone is above the target
+  Fixture f(2048);
+  f.daylight = 800;
+  f.controller.set_target(500);
+  f.run(1);
+  EXPECT_EQ(f.controller.get_level(), 0.0f);
+  EXPECT_EQ(f.chip.output(0).data, 0);
+}
@@ -0,0 +1,175 @@
+// MAX44009 sensor against the chip emulator: measure modes, overflow, adaptive interval and the
+// mode kept across deep sleep.
+
+#include <algorithm>
+
+#include "harness.h"
+#include "max44009_emulator.h"
+#include "esphome/components/max44009/max44009.h"
+
+using namespace esphome;
+using namespace esphome::max44009;
+
+namespace {
+
+struct Fixture {
+  explicit Fixture(MAX44009Mode mode, uint32_t update_interval = 60000) {
+    bus.add_device(&chip);
+    sensor.set_i2c_bus(&bus);
+    sensor.set_i2c_address(0x4A);
+    sensor.set_mode(mode);
+    sensor.set_update_interval(update_interval);
+  }
+
+  test::I2CBusEmulator bus;
+  test::MAX44009Emulator chip;
+  MAX44009Sensor sensor;
+};
+
+}  // namespace
+
+TEST_CASE(auto_mode_follows_the_update_interval) {
+  Fixture slow(MAX44009_MODE_AUTO, 60000);
+  test::setup({&slow.sensor});
+  EXPECT(!slow.chip.is_continuous());
+  Fixture fast(MAX44009_MODE_AUTO, 500);
+  test::setup({&fast.sensor});
+  EXPECT(fast.chip.is_continuous());
+}
+
+TEST_CASE(bus_stats_count_like_the_bus) {
+  Fixture f(MAX44009_MODE_LOW_POWER);
+  bus_stats::BusStats stats;
+  f.sensor.set_bus_stats(&stats);
+  f.chip.set_lux(250);
+  test::setup({&f.sensor});
+  // register reads are 2 transactions, the register write and the read
+  f.sensor.update();
+  EXPECT_EQ(stats.get_transactions(), f.bus.stats().transactions);
+  EXPECT_EQ(stats.get_bytes(), f.bus.stats().bytes);
+}
+
+TEST_CASE(first_reading_after_one_measure_cycle) {
+  Fixture f(MAX44009_MODE_LOW_POWER);
+  f.chip.set_lux(250);
+  test::setup({&f.sensor});
+  test::run_for(790, {&f.sensor});
+  EXPECT_EQ(f.sensor.published.size(), 0u);
+  test::run_for(20, {&f.sensor});
+  EXPECT_EQ(f.sensor.published.size(), 1u);
+  EXPECT_NEAR(f.sensor.state, 250, 2);
+}
+
+TEST_CASE(overflow_sets_an_error) {
+  Fixture f(MAX44009_MODE_LOW_POWER);
+  test::setup({&f.sensor});
+  f.chip.set_lux(NAN);
+  f.sensor.update();
+  EXPECT(f.sensor.status_has_error());
+  EXPECT_EQ(f.sensor.published.size(), 0u);
+  f.chip.set_lux(10);
+  f.sensor.update();
+  EXPECT(!f.sensor.status_has_error());
+  EXPECT_EQ(f.sensor.published.size(), 1u);
+}
+
+TEST_CASE(adaptive_speeds_up_on_change_and_backs_off) {
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+  f.chip.set_lux(1000);
+  test::setup({&f.sensor});
+  // starts slow
+  EXPECT_EQ(f.sensor.get_update_interval(), 8000u);
+  EXPECT(!f.chip.is_continuous());
+  test::run_for(9000, {&f.sensor});
+  // dusk: -50% in a few seconds
+  f.chip.set_lux(500);
+  test::run_for(8000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 500u);
+  EXPECT(f.chip.is_continuous());
+  // steady again: doubles every 2 stable samples up to the maximum
+  test::run_for(60000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 8000u);
+  EXPECT(!f.chip.is_continuous());
+}
+
+TEST_CASE(adaptive_defaults_reach_continuous_mode) {
+  // no set_adaptive(): the defaults of the YAML schema
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.chip.set_lux(1000);
+  test::setup({&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 60000u);
+  test::run_for(61000, {&f.sensor});
+  f.chip.set_lux(200);
+  test::run_for(60000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 500u);
+  EXPECT(f.chip.is_continuous());
+}
+
+TEST_CASE(adaptive_ignores_noise_near_zero) {
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+  f.chip.set_lux(100);
+  test::setup({&f.sensor});
+  test::run_for(9000, {&f.sensor});
+  // lights off, fast change
+  f.chip.set_lux(0);
+  test::run_for(8000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 500u);
+  // a dark room reads 0 and 1 lx in turn, that's not a 100%/min change
+  f.sensor.add_on_state_callback([&f](float lux) { f.chip.set_lux(lux == 0 ? 1 : 0); });
+  test::run_for(60000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 8000u);
+  EXPECT(!f.chip.is_continuous());
+}
+
+TEST_CASE(adaptive_slow_drift_adds_up) {
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+  f.chip.set_lux(10);
+  test::setup({&f.sensor});
+  test::run_for(9000, {&f.sensor});
+  // dusk at low light, 1 lx per sample is within the deadband each time
+  uint32_t fastest = f.sensor.get_update_interval();
+  f.sensor.add_on_state_callback([&f, &fastest](float lux) {
+    f.chip.set_lux(lux > 0 ? lux - 1 : 0);
+    fastest = std::min(fastest, f.sensor.get_update_interval());
+  });
+  test::run_for(40000, {&f.sensor});
+  EXPECT_EQ(fastest, 500u);
+}
+
+TEST_CASE(adaptive_ignores_one_count_in_bright_light) {
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+  f.chip.set_lux(100);
+  test::setup({&f.sensor});
+  test::run_for(9000, {&f.sensor});
+  // lights on, fast change
+  f.chip.set_lux(20000);
+  test::run_for(8000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 500u);
+  // steady sunlight reads one count (92 lx at exponent 11) up and down
+  f.sensor.add_on_state_callback([&f](float lux) { f.chip.set_lux(lux < 20000 ? 20000 + 92.16f : 20000); });
+  test::run_for(60000, {&f.sensor});
+  EXPECT_EQ(f.sensor.get_update_interval(), 8000u);
+  EXPECT(!f.chip.is_continuous());
+}
+
+TEST_CASE(mode_kept_across_deep_sleep) {
+  {
+    Fixture f(MAX44009_MODE_ADAPTIVE);
+    f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+    test::setup({&f.sensor});
+  }
+  // the chip kept its configuration, the RTC state says it's applied
+  Fixture f(MAX44009_MODE_ADAPTIVE);
+  f.sensor.set_adaptive(500, 8000, 0.2f, 2.0f, 2);
+  f.chip.set_configuration(0x03);
+  test::setup({&f.sensor});
+  EXPECT_EQ(f.chip.get_configuration_writes(), 0u);
+  EXPECT_EQ(f.bus.stats().transactions, 0u);
+  // the first value is read right away
+  test::loop({&f.sensor});
+  EXPECT_EQ(f.sensor.published.size(), 1u);
+}
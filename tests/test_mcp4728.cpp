@@ -0,0 +1,341 @@
+// MCP4728 output and light against the chip emulator: readback, write selection, retries and LDAC.
+
+#include "harness.h"
+#include "mcp4728_emulator.h"
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#include "esphome/components/bus_stats/bus_stats.h"
+#include "esphome/components/mcp4728/mcp4728_light.h"
+#include "esphome/components/mcp4728/mcp4728_output.h"
+
+using namespace esphome;
+using namespace esphome::mcp4728;
+using Emulator = test::MCP4728Emulator;
+
+namespace {
+
+struct Fixture {
+  explicit Fixture(bool eeprom = false, uint8_t address = 0x60) : chip(address), dac(eeprom) {
+    bus.add_device(&chip);
+    dac.set_i2c_bus(&bus);
+    dac.set_i2c_address(address);
+    dac.set_bus_stats(&stats);
+  }
+
+  test::I2CBusEmulator bus;
+  Emulator chip;
+  bus_stats::BusStats stats;
+  MCP4728Output dac;
+};
+
+}  // namespace
+
+TEST_CASE(setup_keeps_the_stored_level) {
+  Fixture f;
+  f.chip.set_eeprom(0, Emulator::Channel{1, 0, 0, 2000});
+  f.chip.power_cycle();
+  f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_INTERNAL_2_8V, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  // the configuration matches, so nothing is written over the level restored from EEPROM
+  EXPECT_EQ(f.chip.get_writes(), 0u);
+  EXPECT_EQ(f.chip.output(0).data, 2000);
+  EXPECT_EQ(f.bus.stats().transactions, 1u);
+  EXPECT_EQ(f.stats.get_bytes(), 25u);
+}
+
+TEST_CASE(setup_rewrites_a_mismatched_configuration_at_the_current_level) {
+  Fixture f;
+  f.chip.set_eeprom(1, Emulator::Channel{0, 0, 0, 1234});
+  f.chip.power_cycle();
+  f.dac.create_channel(MCP4728_CHANNEL_B, MCP4728_VREF_INTERNAL_2_8V, MCP4728_GAIN_X2);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  EXPECT(f.chip.output(1) == (Emulator::Channel{1, 0, 1, 1234}));
+  // channels without an output are left alone
+  EXPECT_EQ(f.chip.commands().size(), 1u);
+}
+
+TEST_CASE(setup_fails_without_chip) {
+  Fixture f;
+  f.bus.set_failing(true);
+  test::setup({&f.dac});
+  EXPECT(f.dac.is_failed());
+}
+
+TEST_CASE(two_channels_in_one_multi_write) {
+  Fixture f;
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  auto *c = f.dac.create_channel(MCP4728_CHANNEL_C, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  f.bus.reset_stats();
+  a->set_level(0.5f);
+  c->set_level(1.0f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().transactions, 1u);
+  EXPECT_EQ(f.bus.stats().bytes, 7u);
+  EXPECT_EQ(f.chip.commands().size(), 2u);
+  EXPECT_EQ(f.chip.commands()[0], Emulator::MULTI);
+  EXPECT_EQ(f.chip.output(0).data, 2048);
+  EXPECT_EQ(f.chip.output(2).data, 4095);
+  // unchanged levels aren't written again
+  a->set_level(0.5f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().transactions, 1u);
+}
+
+TEST_CASE(fast_write_from_three_level_changes) {
+  Fixture f;
+  f.dac.set_ldac_tied_low(true);
+  MCP4728Channel *channels[4];
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i] = f.dac.create_channel((MCP4728_CHANNEL) i, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  f.chip.clear_log();
+  f.bus.reset_stats();
+  for (uint8_t i = 0; i < 3; i++)
+    channels[i]->set_level(0.25f * (i + 1));
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().bytes, 9u);
+  EXPECT_EQ(f.chip.commands()[0], Emulator::FAST);
+  EXPECT_EQ(f.chip.output(2).data, 3071);
+  EXPECT_EQ(f.chip.output(3).data, 0);
+}
+
+TEST_CASE(fast_write_keeps_the_configuration) {
+  Fixture f;
+  f.dac.set_ldac_tied_low(true);
+  MCP4728Channel *channels[4];
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i] = f.dac.create_channel((MCP4728_CHANNEL) i, MCP4728_VREF_INTERNAL_2_8V, MCP4728_GAIN_X2);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  f.chip.clear_log();
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i]->set_level(1.0f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.commands()[0], Emulator::FAST);
+  for (uint8_t i = 0; i < 4; i++)
+    EXPECT(f.chip.output(i) == (Emulator::Channel{1, 0, 1, 4095}));
+}
+
+TEST_CASE(no_fast_write_while_ldac_is_high) {
+  Fixture f;
+  // LDAC pulled high and not driven: a Fast Write would never reach the outputs
+  f.chip.set_ldac_high(true);
+  MCP4728Channel *channels[4];
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i] = f.dac.create_channel((MCP4728_CHANNEL) i, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  f.chip.clear_log();
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i]->set_level(1.0f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.commands()[0], Emulator::MULTI);
+  for (uint8_t i = 0; i < 4; i++)
+    EXPECT_EQ(f.chip.output(i).data, 4095);
+}
+
+TEST_CASE(staged_fast_write_is_latched) {
+  Fixture f;
+  test::FakePin ldac;
+  f.chip.attach_ldac(&ldac);
+  f.dac.set_ldac_pin(&ldac);
+  MCP4728Channel *channels[4];
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i] = f.dac.create_channel((MCP4728_CHANNEL) i, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  f.chip.clear_log();
+  for (uint8_t i = 0; i < 4; i++)
+    channels[i]->set_level(1.0f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.commands()[0], Emulator::FAST);
+  EXPECT_EQ(f.chip.get_latches(), 1u);
+  for (uint8_t i = 0; i < 4; i++)
+    EXPECT_EQ(f.chip.output(i).data, 4095);
+}
+
+TEST_CASE(eeprom_sequential_write_from_the_first_dirty_channel) {
+  Fixture f(true);
+  auto *b = f.dac.create_channel(MCP4728_CHANNEL_B, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  f.chip.clear_log();
+  f.bus.reset_stats();
+  b->set_level(1.0f);
+  test::loop({&f.dac});
+  // B to D, 2 bytes per channel after the command byte
+  EXPECT_EQ(f.bus.stats().bytes, 8u);
+  EXPECT_EQ(f.chip.commands().size(), 3u);
+  EXPECT_EQ(f.chip.eeprom(1).data, 4095);
+}
+
+TEST_CASE(failed_write_is_retried_with_back_off) {
+  Fixture f;
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  a->set_level(1.0f);
+  f.bus.fail_next(2);
+  test::loop({&f.dac});
+  EXPECT(f.dac.status_has_warning());
+  EXPECT_EQ(f.chip.output(0).data, 0);
+  // 10 ms until the first retry, which fails too
+  test::advance_ms(5);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().nacks, 1u);
+  test::advance_ms(5);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().nacks, 2u);
+  // then 20 ms
+  test::advance_ms(19);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.output(0).data, 0);
+  test::advance_ms(1);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.output(0).data, 4095);
+  EXPECT(!f.dac.status_has_warning());
+  EXPECT(!f.dac.is_failed());
+}
+
+TEST_CASE(ldac_group_latches_together) {
+  Fixture leader;
+  Fixture follower(false, 0x61);
+  test::FakePin leader_ldac, follower_ldac;
+  leader.chip.attach_ldac(&leader_ldac);
+  follower.chip.attach_ldac(&follower_ldac);
+  leader.dac.set_ldac_pin(&leader_ldac);
+  follower.dac.set_ldac_pin(&follower_ldac);
+  follower.dac.set_sync_leader(&leader.dac);
+  auto *a = leader.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  auto *b = follower.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&leader.dac, &follower.dac});
+  test::loop({&leader.dac, &follower.dac});
+  leader.chip.clear_log();
+  follower.chip.clear_log();
+
+  a->set_level(1.0f);
+  b->set_level(0.5f);
+  // the follower waits for its leader
+  test::loop({&follower.dac});
+  EXPECT_EQ(follower.chip.get_writes(), 0u);
+  test::loop({&leader.dac, &follower.dac});
+  EXPECT_EQ(leader.chip.output(0).data, 4095);
+  EXPECT_EQ(follower.chip.output(0).data, 2048);
+  EXPECT_EQ(leader.chip.get_latches(), 1u);
+  EXPECT_EQ(follower.chip.get_latches(), 1u);
+}
+
+TEST_CASE(staged_write_waits_for_the_latch) {
+  Fixture f;
+  test::FakePin ldac;
+  f.chip.attach_ldac(&ldac);
+  f.dac.set_ldac_pin(&ldac);
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  EXPECT(ldac.value);
+  a->set_level(1.0f);
+  test::loop({&f.dac});
+  // written with UDAC set, the output moved on the LDAC pulse
+  EXPECT_EQ(f.chip.get_latches(), 1u);
+  EXPECT_EQ(f.chip.output(0).data, 4095);
+  EXPECT(ldac.value);
+}
+
+TEST_CASE(failed_write_is_not_latched) {
+  Fixture f;
+  test::FakePin ldac;
+  f.chip.attach_ldac(&ldac);
+  f.dac.set_ldac_pin(&ldac);
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  const uint32_t latches = f.chip.get_latches();
+  a->set_level(1.0f);
+  f.bus.fail_next(1);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.get_latches(), latches);
+  // the retry goes through and is latched
+  test::advance_ms(10);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.get_latches(), latches + 1);
+  EXPECT_EQ(f.chip.output(0).data, 4095);
+}
+
+TEST_CASE(follower_of_a_failed_leader_writes_directly) {
+  Fixture leader;
+  Fixture follower(false, 0x61);
+  // the follower shares the leader's LDAC line, which the leader holds high
+  test::FakePin ldac;
+  ldac.value = true;
+  follower.chip.attach_ldac(&ldac);
+  leader.dac.set_ldac_pin(&ldac);
+  follower.dac.set_sync_leader(&leader.dac);
+  leader.bus.set_failing(true);
+  auto *b = follower.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&leader.dac, &follower.dac});
+  EXPECT(leader.dac.is_failed());
+  b->set_level(0.5f);
+  test::loop({&leader.dac, &follower.dac});
+  EXPECT_EQ(follower.chip.output(0).data, 2048);
+}
+
+TEST_CASE(idle_power_down) {
+  Fixture f;
+  f.dac.set_idle_power_down(PWR_DOWN::GND_500KOHM);
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  // the unconfigured channels and A at zero are powered down
+  for (uint8_t i = 0; i < 4; i++)
+    EXPECT_EQ(f.chip.output(i).pd, 3);
+  a->set_level(0.5f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.output(0).pd, 0);
+  EXPECT_EQ(f.chip.output(1).pd, 3);
+  a->set_level(0.0f);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.chip.output(0).pd, 3);
+}
+
+TEST_CASE(light_colour_in_one_transaction) {
+  Fixture f;
+  MCP4728LightOutput light(&f.dac, MCP4728_LIGHT_RGB);
+  light.add_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  light.add_channel(MCP4728_CHANNEL_B, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  light.add_channel(MCP4728_CHANNEL_C, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac});
+  test::loop({&f.dac});
+  f.bus.reset_stats();
+  light::LightState state;
+  state.set_values(1.0f, 0.5f, 0.0f);
+  light.write_state(&state);
+  test::loop({&f.dac});
+  EXPECT_EQ(f.bus.stats().transactions, 1u);
+  EXPECT_EQ(f.chip.output(0).data, 4095);
+  EXPECT_EQ(f.chip.output(1).data, 2048);
+  EXPECT_EQ(f.chip.output(2).data, 0);
+  EXPECT_EQ(light.get_traits().get_supported_color_modes().count(light::ColorMode::RGB), 1u);
+}
+
+TEST_CASE(bus_scheduler_runs_the_flush_as_actuator_job) {
+  Fixture f;
+  bus_scheduler::BusScheduler sched;
+  f.dac.set_bus_scheduler(&sched);
+  auto *a = f.dac.create_channel(MCP4728_CHANNEL_A, MCP4728_VREF_VDD, MCP4728_GAIN_X1);
+  test::setup({&f.dac, &sched});
+  test::loop({&f.dac, &sched});
+  f.chip.clear_log();
+  int sensor_steps = 0;
+  sched.submit(bus_scheduler::BUS_PRIORITY_SENSOR, [&]() -> uint32_t {
+    sensor_steps++;
+    // the DAC write went ahead of this queued sensor step
+    EXPECT_EQ(f.chip.get_writes(), 1u);
+    return bus_scheduler::BUS_JOB_DONE;
+  });
+  a->set_level(1.0f);
+  test::loop({&f.dac, &sched});
+  EXPECT_EQ(sensor_steps, 1);
+  EXPECT_EQ(f.chip.output(0).data, 4095);
+}
@@ -0,0 +1,320 @@
+// SI1145 component against the chip emulator: setup, measurements, auto range, warm start, output
+// schedules, flicker bursts and enable-gated address assignment.
+
+#include <cmath>
+
+#include "harness.h"
+#include "si1145_emulator.h"
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#include "esphome/components/si1145/si1145.h"
+
+using namespace esphome;
+using namespace esphome::si1145;
+
+namespace {
+
+struct Fixture {
+  explicit Fixture(uint8_t address = 0x60) {
+    bus.add_device(&chip);
+    si.set_i2c_bus(&bus);
+    si.set_i2c_address(address);
+    si.set_update_interval(1000);
+    si.set_visible_sensor(&visible);
+    si.set_infrared_sensor(&infrared);
+    si.set_uvindex_sensor(&uvindex);
+    si.set_illuminance_sensor(&illuminance);
+    si.set_bus_stats(&stats);
+    si.set_visible_range(RANGE_LOW);
+    si.set_infrared_range(RANGE_LOW);
+  }
+
+  test::I2CBusEmulator bus;
+  test::SI1145Emulator chip;
+  bus_stats::BusStats stats;
+  sensor::Sensor visible, infrared, uvindex, illuminance;
+  SI1145Component si;
+};
+
+}  // namespace
+
+TEST_CASE(cold_setup_configures_and_starts_autonomous_mode) {
+  Fixture f;
+  test::setup({&f.si});
+  EXPECT(!f.si.is_failed());
+  EXPECT(f.chip.is_autonomous());
+  EXPECT_EQ(f.chip.get_param(0x01), 0xB1);
+  EXPECT_EQ(f.chip.get_register(0x08), 0xFF);
+}
+
+TEST_CASE(setup_fails_on_wrong_part) {
+  Fixture f;
+  f.bus.set_failing(true);
+  test::setup({&f.si});
+  EXPECT(f.si.is_failed());
+}
+
+TEST_CASE(update_publishes_every_output) {
+  Fixture f;
+  f.chip.set_light(1000, 200);
+  f.chip.set_uv_index(3.5f);
+  test::setup({&f.si});
+  f.si.update();
+  EXPECT_EQ(f.visible.published.size(), 1u);
+  EXPECT_NEAR(f.visible.state, 1000, 1);
+  EXPECT_NEAR(f.infrared.state, 200, 1);
+  EXPECT_EQ(f.uvindex.state, 3.0f);
+  EXPECT_NEAR(f.illuminance.state, 5.41f * 1000 - 0.08f * 200, 1);
+}
+
+TEST_CASE(bus_stats_count_like_the_bus) {
+  Fixture f;
+  f.chip.set_light(1000, 200);
+  test::setup({&f.si});
+  EXPECT_EQ(f.stats.get_transactions(), f.bus.stats().transactions);
+  EXPECT_EQ(f.stats.get_bytes(), f.bus.stats().bytes);
+  // register reads are 2 transactions, the register write and the read
+  f.si.update();
+  EXPECT_EQ(f.stats.get_transactions(), f.bus.stats().transactions);
+  EXPECT_EQ(f.stats.get_bytes(), f.bus.stats().bytes);
+}
+
+TEST_CASE(auto_range_follows_the_light) {
+  Fixture f;
+  f.chip.set_light(100, 100);
+  test::setup({&f.si});
+  // dark: the gain goes up on every update, the scaled value stays put
+  for (int i = 0; i < 3; i++)
+    f.si.update();
+  EXPECT_EQ(f.chip.get_param(0x11), 3);
+  EXPECT_NEAR(f.visible.state, 100, 1);
+  // far too bright for the low range: the forced conversion overflows
+  f.chip.set_light(200000, 100);
+  f.si.update();
+  EXPECT_NEAR(f.visible.state, 100, 1);
+  for (int i = 0; i < 6; i++)
+    f.si.update();
+  EXPECT_EQ(f.chip.get_param(0x12), 0x20);
+  EXPECT_NEAR(f.visible.state, 200000, 200000 * 0.01);
+}
+
+TEST_CASE(warm_start_keeps_the_configuration) {
+  Fixture f;
+  f.chip.set_light(100, 100);
+  test::setup({&f.si});
+  f.si.update();
+  const uint32_t resets = f.chip.get_resets();
+  const uint8_t gain = f.chip.get_param(0x11);
+
+  // the ESP restarts, the chip stays powered
+  sensor::Sensor visible;
+  SI1145Component si;
+  si.set_i2c_bus(&f.bus);
+  si.set_i2c_address(0x60);
+  si.set_update_interval(1000);
+  si.set_visible_sensor(&visible);
+  test::setup({&si});
+  EXPECT_EQ(f.chip.get_resets(), resets);
+  EXPECT_EQ(f.chip.get_param(0x11), gain);
+  // the first value doesn't wait a whole update interval
+  test::loop({&si});
+  EXPECT_EQ(visible.published.size(), 1u);
+}
+
+TEST_CASE(output_schedule_and_delta) {
+  Fixture f;
+  f.si.set_output_schedule(SI1145_OUTPUT_UVINDEX, 10000, 0);
+  f.si.set_output_schedule(SI1145_OUTPUT_VISIBLE, 1000, 50);
+  f.si.set_visible_auto(false);
+  f.si.set_infrared_auto(false);
+  f.chip.set_light(1000, 200);
+  test::set_loop_time(1000, 1000);
+  test::setup({&f.si});
+  test::run_for(11500, {&f.si});
+  EXPECT_EQ(f.uvindex.published.size(), 2u);
+  // unchanged by less than the delta
+  EXPECT_EQ(f.visible.published.size(), 1u);
+  EXPECT_EQ(f.infrared.published.size(), 11u);
+}
+
+TEST_CASE(bus_scheduler_splits_the_measurement) {
+  Fixture f;
+  bus_scheduler::BusScheduler sched;
+  f.si.set_bus_scheduler(&sched);
+  f.chip.set_light(1000, 200);
+  test::setup({&f.si, &sched});
+  test::set_loop_time(1000, 1000);
+  const uint64_t start = test::now_us();
+  f.si.update();
+  // nothing blocks in update(), the read waits 20ms in the queue
+  EXPECT_EQ(test::now_us(), start);
+  test::run_for(19, {&f.si, &sched});
+  EXPECT_EQ(f.visible.published.size(), 0u);
+  test::run_for(5, {&f.si, &sched});
+  EXPECT_EQ(f.visible.published.size(), 1u);
+  EXPECT_NEAR(f.visible.state, 1000, 1);
+}
+
+TEST_CASE(flicker_burst_measures_mains_flicker) {
+  Fixture f;
+  sensor::Sensor index, percent, frequency;
+  f.si.set_flicker(60000, 256);
+  f.si.set_flicker_index_sensor(&index);
+  f.si.set_percent_flicker_sensor(&percent);
+  f.si.set_flicker_frequency_sensor(&frequency);
+  // 100 Hz, 40% modulation
+  f.chip.set_visible_waveform([](uint64_t us) { return 1000 + 400 * std::sin(2 * M_PI * 100 * us / 1e6); });
+  test::setup({&f.si});
+  test::set_loop_time(16000, 200);
+  f.si.start_flicker_burst();
+  test::run_for(300, {&f.si});
+  EXPECT_EQ(frequency.published.size(), 1u);
+  EXPECT_NEAR(frequency.state, 100, 1);
+  EXPECT_NEAR(percent.state, 40, 3);
+  // back to the normal channel list
+  EXPECT_EQ(f.chip.get_param(0x01), 0xB1);
+  EXPECT(!HighFrequencyLoopRequester::is_high_frequency());
+}
+
+TEST_CASE(flicker_burst_at_gain_0) {
+  Fixture f;
+  sensor::Sensor percent, frequency;
+  // dim light at the highest gain, its 3.3ms integration would smooth out the flicker
+  f.si.set_visible_auto(false);
+  f.si.set_visible_gain(7);
+  f.si.set_flicker(60000, 256);
+  f.si.set_percent_flicker_sensor(&percent);
+  f.si.set_flicker_frequency_sensor(&frequency);
+  f.chip.set_visible_waveform([](uint64_t us) { return 100 + 40 * std::sin(2 * M_PI * 100 * us / 1e6); });
+  test::setup({&f.si});
+  test::set_loop_time(16000, 200);
+  f.si.start_flicker_burst();
+  EXPECT_EQ(f.chip.get_param(0x11), 0);
+  test::run_for(300, {&f.si});
+  EXPECT_EQ(frequency.published.size(), 1u);
+  EXPECT_NEAR(frequency.state, 100, 1);
+  EXPECT_NEAR(percent.state, 40, 3);
+  EXPECT_EQ(f.chip.get_param(0x11), 7);
+}
+
+TEST_CASE(flicker_burst_with_long_gaps_is_discarded) {
+  Fixture f;
+  sensor::Sensor percent, frequency;
+  f.si.set_flicker(60000, 64);
+  f.si.set_percent_flicker_sensor(&percent);
+  f.si.set_flicker_frequency_sensor(&frequency);
+  f.chip.set_visible_waveform([](uint64_t us) { return 1000 + 400 * std::sin(2 * M_PI * 100 * us / 1e6); });
+  test::setup({&f.si});
+  // a busy loop that doesn't keep up: one sample every 16ms aliases the 100 Hz flicker
+  test::set_loop_time(16000, 16000);
+  f.si.start_flicker_burst();
+  test::run_for(64 * 16 + 50, {&f.si});
+  EXPECT_EQ(frequency.published.size(), 1u);
+  EXPECT(std::isnan(frequency.state));
+  EXPECT(std::isnan(percent.state));
+}
+
+TEST_CASE(flicker_burst_waits_for_a_queued_measurement) {
+  Fixture f;
+  bus_scheduler::BusScheduler sched;
+  sensor::Sensor frequency;
+  f.si.set_bus_scheduler(&sched);
+  f.si.set_flicker(60000, 256);
+  f.si.set_flicker_frequency_sensor(&frequency);
+  f.chip.set_visible_waveform([](uint64_t us) { return 1000 + 400 * std::sin(2 * M_PI * 100 * us / 1e6); });
+  test::setup({&f.si, &sched});
+  test::set_loop_time(1000, 200);
+  f.si.update();
+  test::run_for(5, {&f.si, &sched});
+  // the measurement is waiting for its conversion, the burst must not change the channel list
+  f.si.start_flicker_burst();
+  EXPECT_EQ(f.chip.get_param(0x01), 0xB1);
+  test::run_for(20, {&f.si, &sched});
+  EXPECT_EQ(f.visible.published.size(), 1u);
+  // started right after the measurement
+  EXPECT(HighFrequencyLoopRequester::is_high_frequency());
+  test::run_for(300, {&f.si, &sched});
+  EXPECT_EQ(frequency.published.size(), 1u);
+  EXPECT_NEAR(frequency.state, 100, 1);
+}
+
+TEST_CASE(enable_pins_assign_addresses) {
+  test::I2CBusEmulator bus;
+  test::SI1145Emulator chip_a, chip_b;
+  test::FakePin pin_a, pin_b;
+  // both start powered at the default address
+  pin_a.value = pin_b.value = true;
+  chip_a.attach_enable(&pin_a);
+  chip_b.attach_enable(&pin_b);
+  bus.add_device(&chip_a);
+  bus.add_device(&chip_b);
+  SI1145Component a, b;
+  a.set_i2c_bus(&bus);
+  b.set_i2c_bus(&bus);
+  a.set_i2c_address(0x61);
+  b.set_i2c_address(0x62);
+  a.set_enable_pin(&pin_a);
+  b.set_enable_pin(&pin_b);
+  test::advance_ms(100);
+  test::setup({&a, &b});
+  EXPECT(!a.is_failed());
+  EXPECT(!b.is_failed());
+  EXPECT_EQ(chip_a.get_address(), 0x61);
+  EXPECT_EQ(chip_b.get_address(), 0x62);
+  EXPECT_EQ(bus.stats().conflicts, 0u);
+}
+
+TEST_CASE(enable_pins_reset_addresses_kept_across_a_reset) {
+  test::I2CBusEmulator bus;
+  test::SI1145Emulator chip_a, chip_b;
+  test::FakePin pin_a, pin_b;
+  // the ESP reset with the chips powered, at each other's address
+  pin_a.value = pin_b.value = true;
+  chip_a.attach_enable(&pin_a);
+  chip_b.attach_enable(&pin_b);
+  chip_a.set_address(0x62);
+  chip_b.set_address(0x61);
+  bus.add_device(&chip_a);
+  bus.add_device(&chip_b);
+  SI1145Component a, b;
+  a.set_i2c_bus(&bus);
+  b.set_i2c_bus(&bus);
+  a.set_i2c_address(0x61);
+  b.set_i2c_address(0x62);
+  a.set_enable_pin(&pin_a);
+  b.set_enable_pin(&pin_b);
+  test::setup({&a, &b});
+  EXPECT(!a.is_failed());
+  EXPECT(!b.is_failed());
+  EXPECT_EQ(chip_a.get_address(), 0x61);
+  EXPECT_EQ(chip_b.get_address(), 0x62);
+}
+
+TEST_CASE(ungated_sensor_moves_before_the_gated_ones_power_up) {
+  test::I2CBusEmulator bus;
+  test::SI1145Emulator chip_a, chip_b, chip_u;
+  test::FakePin pin_a, pin_b;
+  pin_a.value = pin_b.value = true;
+  chip_a.attach_enable(&pin_a);
+  chip_b.attach_enable(&pin_b);
+  bus.add_device(&chip_a);
+  bus.add_device(&chip_b);
+  bus.add_device(&chip_u);
+  SI1145Component a, b, u;
+  for (auto *si : {&a, &b, &u})
+    si->set_i2c_bus(&bus);
+  a.set_i2c_address(0x61);
+  b.set_i2c_address(0x62);
+  u.set_i2c_address(0x63);
+  a.set_enable_pin(&pin_a);
+  b.set_enable_pin(&pin_b);
+  test::advance_ms(100);
+  // the gated sensors are set up first, the ungated one still answers at 0x60 until it's moved
+  test::setup({&a, &b, &u});
+  EXPECT(!a.is_failed());
+  EXPECT(!b.is_failed());
+  EXPECT(!u.is_failed());
+  EXPECT_EQ(chip_a.get_address(), 0x61);
+  EXPECT_EQ(chip_b.get_address(), 0x62);
+  EXPECT_EQ(chip_u.get_address(), 0x63);
+  EXPECT_EQ(bus.stats().conflicts, 0u);
+}
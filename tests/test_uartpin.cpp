@@ -0,0 +1,134 @@
+// UARTPIN outputs against a UART sink: frames, checksums, rate limiting and the line-rate TX queue.
+
+#include <vector>
+
+#include "harness.h"
+#include "uart_sink.h"
+#include "esphome/components/uartpin/uartpin.h"
+
+using namespace esphome;
+using namespace esphome::uartpin;
+
+namespace {
+
+struct Fixture {
+  explicit Fixture(uint32_t baud_rate = 9600) : uart(baud_rate) {
+    pin.set_uart_parent(&uart);
+    test::set_loop_time(1000, 100);
+    test::setup({&pin});
+    // past the init delay, with an idle line
+    test::advance_ms(200);
+    test::loop({&pin});
+  }
+
+  test::UARTSink uart;
+  UARTPINComponent pin;
+};
+
+}  // namespace
+
+TEST_CASE(init_data_after_the_delay) {
+  test::UARTSink uart;
+  UARTPINComponent pin;
+  pin.set_uart_parent(&uart);
+  pin.set_init_data({0xA5, 0x01});
+  pin.set_init_delay(100);
+  test::setup({&pin});
+  auto *channel = pin.create_channel();
+  channel->set_data_high({0x01});
+  // writes before the init are dropped
+  channel->turn_on();
+  test::run_for(50, {&pin});
+  EXPECT_EQ(uart.bytes().size(), 0u);
+  test::run_for(100, {&pin});
+  EXPECT(uart.values() == (std::vector<uint8_t>{0xA5, 0x01}));
+}
+
+TEST_CASE(binary_channel_frames) {
+  Fixture f;
+  auto *channel = f.pin.create_channel();
+  channel->set_data_high({0xA0, 0x01, 0x01});
+  channel->set_data_low({0xA0, 0x01, 0x00});
+  channel->turn_on();
+  channel->turn_off();
+  test::run_for(10, {&f.pin});
+  EXPECT(f.uart.values() == (std::vector<uint8_t>{0xA0, 0x01, 0x01, 0xA0, 0x01, 0x00}));
+}
+
+TEST_CASE(float_channel_level_and_checksum) {
+  Fixture f;
+  auto *channel = f.pin.create_float_channel();
+  channel->set_data_template({0xA0, 0x00, 0x00, 0x00, 0x00});
+  channel->set_level_offset(2);
+  channel->set_level_size(2);
+  channel->set_level_range(0, 1000);
+  channel->set_checksum(UARTPIN_CHECKSUM_SUM, 4);
+  channel->set_level(0.5f);
+  test::run_for(10, {&f.pin});
+  // 500 = 0x01F4, sum of the first 4 bytes
+  EXPECT(f.uart.values() == (std::vector<uint8_t>{0xA0, 0x00, 0x01, 0xF4, 0x95}));
+  // the same level isn't sent again
+  channel->set_level(0.5f);
+  test::run_for(10, {&f.pin});
+  EXPECT_EQ(f.uart.bytes().size(), 5u);
+}
+
+TEST_CASE(float_channel_xor_checksum) {
+  Fixture f;
+  auto *channel = f.pin.create_float_channel();
+  channel->set_data_template({0x55, 0x0F, 0x00, 0x00});
+  channel->set_level_offset(2);
+  channel->set_checksum(UARTPIN_CHECKSUM_XOR, 3);
+  channel->set_level(1.0f);
+  test::run_for(10, {&f.pin});
+  EXPECT(f.uart.values() == (std::vector<uint8_t>{0x55, 0x0F, 0xFF, 0xA5}));
+}
+
+TEST_CASE(min_interval_sends_the_latest_level) {
+  Fixture f;
+  auto *channel = f.pin.create_float_channel();
+  channel->set_data_template({0x00});
+  channel->set_min_interval(100);
+  channel->set_level(0.1f);
+  for (int i = 2; i <= 9; i++) {
+    test::run_for(10, {&f.pin});
+    channel->set_level(i / 10.0f);
+  }
+  test::run_for(200, {&f.pin});
+  // the first level, then the last one once the interval has passed
+  EXPECT(f.uart.values() == (std::vector<uint8_t>{26, 230}));
+}
+
+TEST_CASE(queue_drains_at_the_line_rate_without_blocking) {
+  Fixture f(9600);
+  std::vector<uint8_t> data(200);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = i;
+  bool sent = false;
+  f.pin.write_to_uart(data, [&sent]() { sent = true; });
+  // no more than the FIFO right away
+  EXPECT_EQ(f.uart.bytes().size(), 128u);
+  EXPECT(HighFrequencyLoopRequester::is_high_frequency());
+  test::run_for(300, {&f.pin});
+  EXPECT(f.uart.values() == data);
+  EXPECT(sent);
+  EXPECT_EQ(f.pin.get_tx_max_blocking_us(), 0u);
+  EXPECT(!HighFrequencyLoopRequester::is_high_frequency());
+}
+
+TEST_CASE(budget_restarts_after_a_direct_write) {
+  Fixture f(9600);
+  f.pin.set_tx_buffer_size(16);
+  f.pin.setup();
+  // larger than the buffer: written in one blocking call
+  f.pin.write_to_uart(std::vector<uint8_t>(200, 0x11), nullptr);
+  const uint64_t written = test::now_us();
+  f.pin.write_to_uart(std::vector<uint8_t>(8, 0x22), nullptr);
+  // the line is still busy with the direct write, nothing more may go out yet
+  test::loop({&f.pin});
+  EXPECT_EQ(f.uart.bytes().size(), 200u);
+  test::advance_ms(10);
+  test::loop({&f.pin});
+  EXPECT_EQ(f.uart.bytes().size(), 208u);
+  EXPECT(f.uart.bytes().back().time_us > written);
+}
@@ -0,0 +1,299 @@
+// Replay raw light sensor traces through the component conversion and auto range code.
+//
+// Capture a trace on the device with `trace_size: N` on the si1145 or max44009 sensor, copy the
+// log (the trace is dumped with the config, or by calling dump_trace() from a lambda), then:
+//
+//   g++ -std=c++11 -O2 -I components -o trace_replay tools/trace_replay.cpp
+//   ./trace_replay [--vis-high N] [--vis-low N] [--ir-high N] [--ir-low N] < device.log
+//
+// For every sample the tool prints the values the device published and, for the SI1145, the
+// values and range/gain an auto range run with the given thresholds would have produced, followed
+// by a summary with the number of range/gain changes and the settle time of both runs.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "max44009/max44009_calc.h"
+#include "si1145/si1145_calc.h"
+
+using namespace esphome;
+
+struct Trace {
+  std::string name;
+  size_t sample_size = 0;
+  std::string info;
+  std::vector<uint8_t> data;
+};
+
+struct Thresholds {
+  uint16_t vis_high = si1145::AUTO_RANGE_HIGH;
+  uint16_t vis_low = si1145::AUTO_RANGE_LOW;
+  uint16_t ir_high = si1145::AUTO_RANGE_HIGH;
+  uint16_t ir_low = si1145::AUTO_RANGE_LOW;
+};
+
+// Settle time: from the first range/gain change of a streak to the first sample without a change
+struct SettleStats {
+  uint32_t changes = 0;
+  uint32_t streaks = 0;
+  uint32_t total_ms = 0;
+  uint32_t max_ms = 0;
+  bool settling = false;
+  uint32_t since = 0;
+
+  void add(uint32_t timestamp, bool changed) {
+    if (changed) {
+      this->changes++;
+      if (!this->settling) {
+        this->settling = true;
+        this->since = timestamp;
+      }
+    } else if (this->settling) {
+      uint32_t t = timestamp - this->since;
+      this->settling = false;
+      this->streaks++;
+      this->total_ms += t;
+      if (t > this->max_ms)
+        this->max_ms = t;
+    }
+  }
+
+  void print(const char *label) const {
+    printf("# %s: %u range/gain changes, settle time avg %u ms, max %u ms%s\n", label, this->changes,
+           this->streaks > 0 ? this->total_ms / this->streaks : 0, this->max_ms,
+           this->settling ? " (not settled at end of trace)" : "");
+  }
+};
+
+static bool parse_hex(const char *hex, std::vector<uint8_t> *out) {
+  while (hex[0] != '\0' && hex[1] != '\0') {
+    if (hex[0] == '.' || hex[0] == ' ') {
+      hex++;
+      continue;
+    }
+    char byte[3] = {hex[0], hex[1], '\0'};
+    char *end;
+    long v = strtol(byte, &end, 16);
+    if (*end != '\0')
+      return false;
+    out->push_back(static_cast<uint8_t>(v));
+    hex += 2;
+  }
+  return true;
+}
+
+static std::vector<Trace> read_traces(FILE *in) {
+  std::vector<Trace> traces;
+  Trace *current = nullptr;
+  char line[2048];
+  while (fgets(line, sizeof(line), in) != nullptr) {
+    line[strcspn(line, "\r\n")] = '\0';
+    // strip ANSI colors of the ESPHome log
+    std::string clean;
+    for (const char *p = line; *p != '\0'; p++) {
+      if (*p == '\033') {
+        while (*p != '\0' && *p != 'm')
+          p++;
+        if (*p == '\0')
+          break;
+        continue;
+      }
+      clean += *p;
+    }
+    size_t pos = clean.find("trace ");
+    if (pos == std::string::npos)
+      continue;
+    const char *rest = clean.c_str() + pos + 6;
+    char name[32];
+    unsigned size, count;
+    int consumed = 0;
+    if (sscanf(rest, "%31s begin size=%u count=%u%n", name, &size, &count, &consumed) == 3) {
+      traces.emplace_back();
+      current = &traces.back();
+      current->name = name;
+      current->sample_size = size;
+      current->info = rest + consumed;
+      current->info.erase(0, current->info.find_first_not_of(' '));
+      continue;
+    }
+    if (current == nullptr)
+      continue;
+    std::string data_prefix = current->name + ": ";
+    std::string end_marker = current->name + " end";
+    if (strncmp(rest, data_prefix.c_str(), data_prefix.size()) == 0) {
+      if (!parse_hex(rest + data_prefix.size(), &current->data))
+        fprintf(stderr, "Ignoring malformed trace line: %s\n", clean.c_str());
+    } else if (strncmp(rest, end_marker.c_str(), end_marker.size()) == 0) {
+      current = nullptr;
+    }
+  }
+  return traces;
+}
+
+static unsigned info_value(const std::string &info, const char *key) {
+  size_t pos = info.find(key);
+  if (pos == std::string::npos)
+    return 0;
+  return strtoul(info.c_str() + pos + strlen(key), nullptr, 10);
+}
+
+// Light level independent of range and gain, or a negative value on overflow
+static float normalize(uint16_t raw, uint8_t config) {
+  if (raw == OVERFLOW_VALUE)
+    return -1.0f;
+  return si1145::apply_range_and_gain(raw, config & si1145::RANGE_HIGH, config & 0x07);
+}
+
+// Raw reading the chip would return for a normalized light level with the given range and gain
+static uint16_t simulate(float level, si1145::Range range, uint8_t gain) {
+  if (level < 0)
+    return OVERFLOW_VALUE;
+  float range_factor = (range == si1145::RANGE_LOW) ? 1.0f : 14.5f;
+  float raw = level * (1 << gain) / range_factor;
+  if (raw >= OVERFLOW_VALUE)
+    return OVERFLOW_VALUE;
+  return static_cast<uint16_t>(raw);
+}
+
+// Published value, or an empty CSV field on overflow
+static std::string format_lux(float lux) {
+  if (lux < 0)
+    return "";
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%.1f", lux);
+  return buf;
+}
+
+static void replay_si1145(const Trace &trace, const Thresholds &thresholds) {
+  if (trace.sample_size != sizeof(si1145::SI1145TraceSample)) {
+    fprintf(stderr, "Unexpected si1145 sample size %zu\n", trace.sample_size);
+    return;
+  }
+  const uint16_t temp_at_begin = info_value(trace.info, "temp_at_begin=");
+  const bool vis_temp_correction = info_value(trace.info, "vis_temp_correction=");
+  const bool ir_temp_correction = info_value(trace.info, "ir_temp_correction=");
+  const size_t count = trace.data.size() / trace.sample_size;
+
+  printf("# si1145: %zu samples, %s\n", count, trace.info.c_str());
+  printf("timestamp,vis_raw,vis_range,vis_gain,ir_raw,ir_range,ir_gain,lux,"
+         "replay_vis_raw,replay_vis_range,replay_vis_gain,replay_ir_raw,replay_ir_range,replay_ir_gain,replay_lux\n");
+
+  SettleStats recorded, replayed;
+  uint32_t overflows = 0, replay_overflows = 0;
+  si1145::Range vis_range = si1145::RANGE_LOW, ir_range = si1145::RANGE_LOW;
+  uint8_t vis_gain = 0, ir_gain = 0;
+  for (size_t i = 0; i < count; i++) {
+    si1145::SI1145TraceSample s;
+    memcpy(&s, &trace.data[i * trace.sample_size], sizeof(s));
+    if (i == 0) {
+      // the replay starts from the settings the device had
+      vis_range = static_cast<si1145::Range>(s.visible_config & si1145::RANGE_HIGH);
+      vis_gain = s.visible_config & 0x07;
+      ir_range = static_cast<si1145::Range>(s.infrared_config & si1145::RANGE_HIGH);
+      ir_gain = s.infrared_config & 0x07;
+    } else {
+      si1145::SI1145TraceSample prev;
+      memcpy(&prev, &trace.data[(i - 1) * trace.sample_size], sizeof(prev));
+      recorded.add(s.timestamp,
+                   prev.visible_config != s.visible_config || prev.infrared_config != s.infrared_config);
+    }
+
+    // what the device published
+    const uint8_t rec_vis_range = s.visible_config & si1145::RANGE_HIGH, rec_vis_gain = s.visible_config & 0x07;
+    const uint8_t rec_ir_range = s.infrared_config & si1145::RANGE_HIGH, rec_ir_gain = s.infrared_config & 0x07;
+    float lux = -1;
+    if (s.visible != OVERFLOW_VALUE && s.infrared != OVERFLOW_VALUE) {
+      float vis = s.visible, ir = s.infrared;
+      if (vis_temp_correction)
+        vis = si1145::visible_temp_correction(s.visible, rec_vis_range, rec_vis_gain, s.temp, temp_at_begin);
+      if (ir_temp_correction)
+        ir = si1145::infrared_temp_correction(s.infrared, rec_ir_range, rec_ir_gain, s.temp, temp_at_begin);
+      lux = si1145::illumination_combine_sensors(vis, rec_vis_range, rec_vis_gain, ir, rec_ir_range, rec_ir_gain);
+    } else {
+      overflows++;
+    }
+
+    // what the replayed auto range would have read and published
+    uint16_t vis_raw = simulate(normalize(s.visible, s.visible_config), vis_range, vis_gain);
+    uint16_t ir_raw = simulate(normalize(s.infrared, s.infrared_config), ir_range, ir_gain);
+    float replay_lux = -1;
+    if (vis_raw != OVERFLOW_VALUE && ir_raw != OVERFLOW_VALUE) {
+      replay_lux = si1145::illumination_combine_sensors(vis_raw, vis_range, vis_gain, ir_raw, ir_range, ir_gain);
+    } else {
+      replay_overflows++;
+    }
+
+    printf("%u,%u,%s,%u,%u,%s,%u,%s,%u,%s,%u,%u,%s,%u,%s\n", s.timestamp, s.visible,
+           rec_vis_range ? "high" : "low", rec_vis_gain, s.infrared, rec_ir_range ? "high" : "low", rec_ir_gain,
+           format_lux(lux).c_str(), vis_raw, vis_range ? "high" : "low", vis_gain, ir_raw, ir_range ? "high" : "low",
+           ir_gain, format_lux(replay_lux).c_str());
+
+    uint8_t changed = si1145::auto_range_visible(vis_raw, vis_range, vis_gain, thresholds.vis_high, thresholds.vis_low);
+    changed |= si1145::auto_range_infrared(ir_raw, ir_range, ir_gain, thresholds.ir_high, thresholds.ir_low);
+    if (i + 1 < count) {
+      si1145::SI1145TraceSample next;
+      memcpy(&next, &trace.data[(i + 1) * trace.sample_size], sizeof(next));
+      replayed.add(next.timestamp, changed != 0);
+    }
+  }
+  recorded.print("recorded");
+  replayed.print("replayed");
+  printf("# overflows: recorded %u, replayed %u\n", overflows, replay_overflows);
+}
+
+static void replay_max44009(const Trace &trace) {
+  if (trace.sample_size != sizeof(max44009::MAX44009TraceSample)) {
+    fprintf(stderr, "Unexpected max44009 sample size %zu\n", trace.sample_size);
+    return;
+  }
+  const size_t count = trace.data.size() / trace.sample_size;
+  printf("# max44009: %zu samples\n", count);
+  printf("timestamp,datahigh,datalow,lux\n");
+  for (size_t i = 0; i < count; i++) {
+    max44009::MAX44009TraceSample s;
+    memcpy(&s, &trace.data[i * trace.sample_size], sizeof(s));
+    if ((s.datahigh >> 4) == 0x0F) {
+      printf("%u,%u,%u,overflow\n", s.timestamp, s.datahigh, s.datalow);
+    } else {
+      printf("%u,%u,%u,%d\n", s.timestamp, s.datahigh, s.datalow, max44009::convert_to_lux(s.datahigh, s.datalow));
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  Thresholds thresholds;
+  for (int i = 1; i < argc; i++) {
+    uint16_t *target = nullptr;
+    if (strcmp(argv[i], "--vis-high") == 0)
+      target = &thresholds.vis_high;
+    else if (strcmp(argv[i], "--vis-low") == 0)
+      target = &thresholds.vis_low;
+    else if (strcmp(argv[i], "--ir-high") == 0)
+      target = &thresholds.ir_high;
+    else if (strcmp(argv[i], "--ir-low") == 0)
+      target = &thresholds.ir_low;
+    if (target == nullptr || i + 1 >= argc) {
+      fprintf(stderr, "Usage: %s [--vis-high N] [--vis-low N] [--ir-high N] [--ir-low N] < device.log\n", argv[0]);
+      return 1;
+    }
+    *target = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 10));
+  }
+
+  std::vector<Trace> traces = read_traces(stdin);
+  if (traces.empty()) {
+    fprintf(stderr, "No trace found in input\n");
+    return 1;
+  }
+  for (const Trace &trace : traces) {
+    if (trace.name == "si1145")
+      replay_si1145(trace, thresholds);
+    else if (trace.name == "max44009")
+      replay_max44009(trace);
+    else
+      fprintf(stderr, "Skipping unknown trace '%s'\n", trace.name.c_str());
+  }
+  return 0;
+}